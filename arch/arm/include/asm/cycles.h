@@ -8,16 +8,123 @@ typedef unsigned long cycles_t;
 /* system call wrapper */
 int null_call(cycles_t *timestamp);
 
+#if defined(__ARM_ARCH) && __ARM_ARCH >= 7 && \
+	defined(__ARM_ARCH_PROFILE) && __ARM_ARCH_PROFILE == 'A'
+
+/* ARMv7-A cores with the Generic Timer extension (Cortex-A7, A15, and later)
+ * provide the virtual count register CNTVCT, which the kernel normally makes
+ * readable from user space. Older cores (e.g., Cortex-A8/A9) and kernels that
+ * disable user access trap with SIGILL, so availability is probed at run
+ * time. cycles_t remains 32 bits wide to match null_call(); differences are
+ * still correct modulo 2^32.
+ */
+#define ASM_CYCLES_NEED_PROBE
+
+/* -1: not yet probed, 0: use null_call(), 1: read CNTVCT directly */
+extern int user_cycle_counter;
+int probe_user_cycle_counter(void);
+
+static inline unsigned long long read_cntvct(void)
+{
+	unsigned int lo, hi;
+	__asm__ __volatile__("mrrc p15, 1, %0, %1, c14" : "=r" (lo), "=r" (hi));
+	return ((unsigned long long) hi << 32) | lo;
+}
+
+static inline int have_user_cycle_counter(void)
+{
+	return __builtin_expect(user_cycle_counter > 0, 1) ||
+		(user_cycle_counter < 0 && probe_user_cycle_counter());
+}
+
+static inline cycles_t syscall_cycles(void)
+{
+	cycles_t c;
+	null_call(&c);
+	return c;
+}
+
+static inline cycles_t get_cycles_unordered(void)
+{
+	if (have_user_cycle_counter())
+		return read_cntvct();
+	return syscall_cycles();
+}
+
+/* The isb keeps the counter read from being executed early (or late). */
+static inline cycles_t get_cycles_ordered(void)
+{
+	cycles_t c;
+
+	if (!have_user_cycle_counter())
+		return syscall_cycles();
+	__asm__ __volatile__("isb" : : : "memory");
+	c = read_cntvct();
+	__asm__ __volatile__("isb" : : : "memory");
+	return c;
+}
+
+static inline cycles_t get_cycles_serialized(void)
+{
+	cycles_t c;
+
+	if (!have_user_cycle_counter())
+		return syscall_cycles();
+	__asm__ __volatile__("dsb sy; isb" : : : "memory");
+	c = read_cntvct();
+	__asm__ __volatile__("isb" : : : "memory");
+	return c;
+}
+
+static inline cycles_t get_cycles(void)
+{
+	return get_cycles_ordered();
+}
+
+/* The Generic Timer runs at a fixed frequency... */
+static inline int cycles_invariant(void)
+{
+	return have_user_cycle_counter();
+}
+
+/* ...that firmware advertises in CNTFRQ (0 if not set up). */
+static inline unsigned long long cycles_nominal_frequency(void)
+{
+	unsigned int freq = 0;
+
+	if (have_user_cycle_counter())
+		__asm__ __volatile__("mrc p15, 0, %0, c14, c0, 0" : "=r" (freq));
+	return freq;
+}
+
+#else
+
 static inline cycles_t get_cycles(void)
 {
 	cycles_t c;
 	/* On the ARM11 MPCore chips, userspace cannot access the cycle counter
-	 * directly. So ask the kernel to read it instead. Eventually, this
-	 * should support newer ARM chips that do allow accessing the cycle
-	 * counter in userspace.
+	 * directly. So ask the kernel to read it instead.
 	 */
 	null_call(&c);
 	return c;
 }
 
+/* The system call orders the read anyway. */
+#define get_cycles_unordered()  get_cycles()
+#define get_cycles_ordered()    get_cycles()
+#define get_cycles_serialized() get_cycles()
+
+/* Nothing is known about the kernel's choice of counter. */
+static inline int cycles_invariant(void)
+{
+	return 0;
+}
+
+static inline unsigned long long cycles_nominal_frequency(void)
+{
+	return 0;
+}
+
+#endif
+
 #endif
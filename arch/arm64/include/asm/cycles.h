@@ -0,0 +1,62 @@
+#ifndef ASM_CYCLES_H
+#define ASM_CYCLES_H
+
+typedef unsigned long cycles_t;
+
+#define CYCLES_FMT "lu"
+
+/* system call wrapper */
+int null_call(cycles_t *timestamp);
+
+/* Linux always grants EL0 access to the virtual count register of the
+ * Generic Timer on arm64, so no system call is needed to read time stamps.
+ */
+
+static inline cycles_t get_cycles_unordered(void)
+{
+	cycles_t c;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r" (c));
+	return c;
+}
+
+/* The isb keeps the counter read from being executed early (or late). */
+static inline cycles_t get_cycles_ordered(void)
+{
+	cycles_t c;
+
+	__asm__ __volatile__("isb" : : : "memory");
+	c = get_cycles_unordered();
+	__asm__ __volatile__("isb" : : : "memory");
+	return c;
+}
+
+static inline cycles_t get_cycles_serialized(void)
+{
+	cycles_t c;
+
+	__asm__ __volatile__("dsb sy; isb" : : : "memory");
+	c = get_cycles_unordered();
+	__asm__ __volatile__("isb" : : : "memory");
+	return c;
+}
+
+static inline cycles_t get_cycles(void)
+{
+	return get_cycles_ordered();
+}
+
+/* The Generic Timer runs at a fixed frequency... */
+static inline int cycles_invariant(void)
+{
+	return 1;
+}
+
+/* ...that firmware advertises in CNTFRQ (0 if not set up). */
+static inline unsigned long long cycles_nominal_frequency(void)
+{
+	unsigned long freq;
+	__asm__ __volatile__("mrs %0, cntfrq_el0" : "=r" (freq));
+	return freq;
+}
+
+#endif
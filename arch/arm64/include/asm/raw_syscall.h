@@ -0,0 +1,33 @@
+#ifndef ASM_RAW_SYSCALL_H
+#define ASM_RAW_SYSCALL_H
+
+/* Inline system call stubs that avoid the variadic syscall() of the C
+ * library. They return the kernel's result: -errno on failure. */
+
+#define LITMUS_RAW_SYSCALLS 1
+
+static inline long litmus_raw_syscall0(long nr)
+{
+	register long x8 __asm__("x8") = nr;
+	register long x0 __asm__("x0");
+
+	__asm__ __volatile__("svc #0"
+			     : "=r" (x0)
+			     : "r" (x8)
+			     : "memory");
+	return x0;
+}
+
+static inline long litmus_raw_syscall1(long nr, long a1)
+{
+	register long x8 __asm__("x8") = nr;
+	register long x0 __asm__("x0") = a1;
+
+	__asm__ __volatile__("svc #0"
+			     : "+r" (x0)
+			     : "r" (x8)
+			     : "memory");
+	return x0;
+}
+
+#endif
@@ -13,4 +13,20 @@ static inline cycles_t get_cycles(void) {
 	return cycles & ~(1UL << NPT_BIT);
 }
 
+/* %stick is not speculated, so all variants are equivalent. */
+#define get_cycles_unordered()  get_cycles()
+#define get_cycles_ordered()    get_cycles()
+#define get_cycles_serialized() get_cycles()
+
+/* %stick runs at a constant rate independent of the CPU clock. */
+static inline int cycles_invariant(void)
+{
+	return 1;
+}
+
+static inline unsigned long long cycles_nominal_frequency(void)
+{
+	return 0;
+}
+
 #endif
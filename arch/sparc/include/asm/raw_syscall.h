@@ -0,0 +1,7 @@
+#ifndef ASM_RAW_SYSCALL_H
+#define ASM_RAW_SYSCALL_H
+
+/* No inline system call stubs (LITMUS_RAW_SYSCALLS is not defined); the
+ * out-of-line wrappers in src/syscalls.c are used. */
+
+#endif
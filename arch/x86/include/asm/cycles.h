@@ -1,6 +1,8 @@
 #ifndef ASM_CYCLES_H
 #define ASM_CYCLES_H
 
+#include <cpuid.h>
+
 #define rdtscll(val) do { \
 	unsigned int __a,__d; \
 	__asm__ __volatile__("rdtsc" : "=a" (__a), "=d" (__d)); \
@@ -27,4 +29,60 @@ static inline cycles_t get_cycles(void)
 	return native_read_tsc();
 }
 
+/* Plain rdtsc. May be executed before preceding instructions have completed
+ * and after subsequent ones have started. Cheapest, but only useful for
+ * coarse-grained time stamps. */
+static inline cycles_t get_cycles_unordered(void)
+{
+	cycles_t val;
+	rdtscll(val);
+	return val;
+}
+
+/* The first lfence keeps rdtsc from executing before all prior instructions
+ * have completed locally, the second keeps later instructions from starting
+ * before the counter has been read. Unlike rdtscp, this works on every CPU
+ * with SSE2. */
+static inline cycles_t get_cycles_ordered(void)
+{
+	cycles_t val;
+
+	__asm__ __volatile__("lfence":::"memory");
+	rdtscll(val);
+	__asm__ __volatile__("lfence":::"memory");
+
+	return val;
+}
+
+/* Additionally waits for all prior loads and stores to become globally
+ * visible (Intel SDM: "MFENCE;LFENCE immediately before RDTSC"). */
+static inline cycles_t get_cycles_serialized(void)
+{
+	cycles_t val;
+
+	__asm__ __volatile__("mfence; lfence":::"memory");
+	rdtscll(val);
+	__asm__ __volatile__("lfence":::"memory");
+
+	return val;
+}
+
+/* Does the TSC tick at a constant rate in all C/P-states? */
+static inline int cycles_invariant(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+
+	if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) &&
+	    eax >= 0x80000007 &&
+	    __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx))
+		return (edx >> 8) & 1;
+	return 0;
+}
+
+/* The TSC frequency is not reliably discoverable; it must be calibrated. */
+static inline unsigned long long cycles_nominal_frequency(void)
+{
+	return 0;
+}
+
 #endif
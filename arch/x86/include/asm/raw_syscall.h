@@ -0,0 +1,37 @@
+#ifndef ASM_RAW_SYSCALL_H
+#define ASM_RAW_SYSCALL_H
+
+/* Inline system call stubs that avoid the variadic syscall() of the C
+ * library. They return the kernel's result: -errno on failure. Only x86-64
+ * is supported; on i386, %ebx may be reserved for PIC code and the
+ * out-of-line wrappers are used instead. */
+
+#ifdef __x86_64__
+
+#define LITMUS_RAW_SYSCALLS 1
+
+static inline long litmus_raw_syscall0(long nr)
+{
+	long ret;
+
+	__asm__ __volatile__("syscall"
+			     : "=a" (ret)
+			     : "a" (nr)
+			     : "rcx", "r11", "memory");
+	return ret;
+}
+
+static inline long litmus_raw_syscall1(long nr, long a1)
+{
+	long ret;
+
+	__asm__ __volatile__("syscall"
+			     : "=a" (ret)
+			     : "a" (nr), "D" (a1)
+			     : "rcx", "r11", "memory");
+	return ret;
+}
+
+#endif
+
+#endif
@@ -4,23 +4,19 @@
  * real-time task. Familiarity with the single threaded example (base_task.c)
  * is assumed.
  *
- * Currently, liblitmus still lacks automated support for real-time
- * tasks, but internaly it is thread-safe, and thus can be used together
- * with pthreads.
+ * liblitmus is internally thread-safe, and thus can be used together with
+ * pthreads. litmus_threads_create() (see rt_thread.h) admits a batch of
+ * real-time threads: each thread sets itself up as a real-time task, and none
+ * of them starts executing jobs before all of them have been admitted.
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-/* Include gettid() */
-#include <sys/types.h>
-
-/* Include threading support. */
-#include <pthread.h>
-
-/* Include the LITMUS^RT API.*/
+/* Include the LITMUS^RT API and real-time threading support. */
 #include "litmus.h"
+#include "rt_thread.h"
 
 #define PERIOD            100
 #define RELATIVE_DEADLINE 100
@@ -61,13 +57,15 @@ int job(void);
 
 
 /* Basic setup is the same as in the single-threaded example. However, 
- * we do some thread initiliazation first before invoking the job.
+ * task parameters are specified per thread.
  */
 int main(int argc, char** argv)
 {
 	int i;
-	struct thread_context ctx[NUM_THREADS];
-	pthread_t             task[NUM_THREADS];
+	lt_t setup_time;
+	struct thread_context     ctx[NUM_THREADS];
+	struct litmus_thread_spec spec[NUM_THREADS];
+	pthread_t                 task[NUM_THREADS];
 
 	/* The task is in background mode upon startup. */		
 
@@ -93,13 +91,50 @@ int main(int argc, char** argv)
 
 
 	/***** 
-	 * 4) Launch threads.
+	 * 4) Describe and launch threads.
 	 */
 	for (i = 0; i < NUM_THREADS; i++) {
 		ctx[i].id = i;
-		pthread_create(task + i, NULL, rt_thread, (void *) (ctx + i));
+
+		init_rt_task_param(&spec[i].params);
+		spec[i].params.exec_cost = ms2ns(EXEC_COST);
+		spec[i].params.period = ms2ns(PERIOD);
+		spec[i].params.relative_deadline = ms2ns(RELATIVE_DEADLINE);
+
+		/* What to do in the case of budget overruns? */
+		spec[i].params.budget_policy = NO_ENFORCEMENT;
+
+		/* The task class parameter is ignored by most plugins. */
+		spec[i].params.cls = RT_CLASS_SOFT;
+
+		/* The priority parameter is only used by fixed-priority
+		 * plugins. */
+		spec[i].params.priority = LITMUS_LOWEST_PRIORITY;
+
+		/* To specify a partition or cluster, set
+		 *
+		 * spec[i].domain = DOMAIN;
+		 *
+		 * where DOMAIN ranges from 0 to "Number of domains" - 1. The
+		 * thread then migrates there before it becomes a real-time
+		 * task.
+		 */
+		spec[i].domain = -1;
+
+		/* Use a default pthread stack. See rt_stack_alloc() for
+		 * locked, prefaulted stacks. */
+		spec[i].stack = NULL;
+
+		spec[i].start_routine = rt_thread;
+		spec[i].arg = ctx + i;
 	}
 
+	/* Passing LITMUS_THREADS_WAIT_RELEASE instead of 0 would make all
+	 * threads wait for a synchronous release (see release_ts). */
+	CALL( litmus_threads_create(task, spec, NUM_THREADS, 0, &setup_time) );
+	fprintf(stderr, "Admitted %d threads in %llu us.\n", NUM_THREADS,
+		(unsigned long long) (setup_time / 1000));
+
 	
 	/*****
 	 * 5) Wait for RT threads to terminate.
@@ -117,60 +152,20 @@ int main(int argc, char** argv)
 
 
 /* A real-time thread is very similar to the main function of a single-threaded
- * real-time app. Notice, that init_rt_thread() is called to initialized per-thread
- * data structures of the LITMUS^RT user space libary.
+ * real-time app. litmus_threads_create() already called init_rt_thread(),
+ * set_rt_task_param(), and task_mode(LITMUS_RT_TASK) on its behalf, so the
+ * thread is executing as a real-time task when it gets here.
  */
 void* rt_thread(void *tcontext)
 {
 	int do_exit;
 	struct thread_context *ctx = (struct thread_context *) tcontext;
-	struct rt_task param;
-
-	/* Set up task parameters */
-	init_rt_task_param(&param);
-	param.exec_cost = ms2ns(EXEC_COST);
-	param.period = ms2ns(PERIOD);
-	param.relative_deadline = ms2ns(RELATIVE_DEADLINE);
-
-	/* What to do in the case of budget overruns? */
-	param.budget_policy = NO_ENFORCEMENT;
-
-	/* The task class parameter is ignored by most plugins. */
-	param.cls = RT_CLASS_SOFT;
-
-	/* The priority parameter is only used by fixed-priority plugins. */
-	param.priority = LITMUS_LOWEST_PRIORITY;
 
 	/* Make presence visible. */
 	printf("RT Thread %d active.\n", ctx->id);
 
 	/*****
-	 * 1) Initialize real-time settings.
-	 */
-	CALL( init_rt_thread() );
-
-	/* To specify a partition, do
-	 *
-	 * param.cpu = CPU;
-	 * be_migrate_to(CPU);
-	 *
-	 * where CPU ranges from 0 to "Number of CPUs" - 1 before calling
-	 * set_rt_task_param().
-	 */
-	CALL( set_rt_task_param(gettid(), &param) );
-
-	/*****
-	 * 2) Transition to real-time mode.
-	 */
-	CALL( task_mode(LITMUS_RT_TASK) );
-
-	/* The task is now executing as a real-time task if the call didn't fail. 
-	 */
-
-
-
-	/*****
-	 * 3) Invoke real-time jobs.
+	 * 1) Invoke real-time jobs.
 	 */
 	do {
 		/* Wait until the next job is released. */
@@ -182,7 +177,7 @@ void* rt_thread(void *tcontext)
 
 	
 	/*****
-	 * 4) Transition to background mode.
+	 * 2) Transition to background mode.
 	 */
 	CALL( task_mode(BACKGROUND_TASK) );
 
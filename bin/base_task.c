@@ -16,9 +16,11 @@
 
 /* Second, we include the LITMUS^RT user space library header.
  * This header, part of liblitmus, provides the user space API of
- * LITMUS^RT.
+ * LITMUS^RT. Optional modules, such as the job runner used below, have
+ * headers of their own.
  */
 #include "litmus.h"
+#include "job_runner.h"
 
 /* Next, we define period and execution cost to be constant. 
  * These are only constants for convenience in this example, they can be
@@ -46,7 +48,7 @@
  * Returns 1 -> task should exit.
  *         0 -> task should continue.
  */
-int job(void);
+int job(void *arg);
 
 /* typically, main() does a couple of things: 
  * 	1) parse command line parameters, etc.
@@ -63,8 +65,8 @@ int job(void);
  */
 int main(int argc, char** argv)
 {
-	int do_exit;
 	struct rt_task param;
+	struct job_runner runner;
 
 	/* Setup task parameters */
 	init_rt_task_param(&param);
@@ -129,13 +131,13 @@ int main(int argc, char** argv)
 
 	/*****
 	 * 5) Invoke real-time jobs.
+	 *    The job runner waits for each job release with
+	 *    sleep_next_period() and invokes job() until it returns 1.
+	 *    Callbacks for deadline misses and budget overruns could be
+	 *    installed in runner.on_miss and runner.on_overrun.
 	 */
-	do {
-		/* Wait until the next job is released. */
-		sleep_next_period();
-		/* Invoke job. */
-		do_exit = job();		
-	} while (!do_exit);
+	CALL( init_job_runner(&runner, job, NULL) );
+	CALL( run_jobs(&runner) );
 
 
 	
@@ -149,11 +151,15 @@ int main(int argc, char** argv)
 	/***** 
 	 * 7) Clean up, maybe print results and stats, and exit.
 	 */
+	printf("%llu jobs, %llu deadline misses, max. response time %llu ns\n",
+	       (unsigned long long) runner.stats->jobs,
+	       (unsigned long long) runner.stats->misses,
+	       (unsigned long long) runner.stats->max_response);
 	return 0;
 }
 
 
-int job(void) 
+int job(void *arg) 
 {
 	/* Do real-time calculation. */
 
@@ -0,0 +1,139 @@
+/* coro_mux.cpp -- several periodic activities in one real-time task.
+ *
+ * Runs coroutines with periods of 10, 20, and 40 ms in a single
+ * LITMUS^RT task whose period is their greatest common divisor. Two of them
+ * share a cooperative mutex across a preemption point.
+ *
+ * Build with 'make coro_mux' (requires a C++20 compiler).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "litmus.h"
+#include "litmus_coro.hpp"
+
+using namespace litmus::coro;
+
+static mutex shared;
+static volatile unsigned long counter;
+
+static void burn(unsigned long loops)
+{
+	for (unsigned long i = 0; i < loops; i++)
+		counter = counter + 1;
+}
+
+static activity sampler(unsigned long loops)
+{
+	for (;;) {
+		burn(loops);
+		co_await next_period();
+	}
+}
+
+static activity writer(unsigned long loops, int jobs)
+{
+	for (int i = 0; i < jobs; i++) {
+		co_await shared.lock();
+		burn(loops);
+		/* let the sampler run, but keep the lock */
+		co_await preemption_point();
+		burn(loops);
+		shared.unlock();
+		co_await next_period();
+	}
+}
+
+/* ends the multiplexer after a number of its own jobs */
+static activity timer(multiplexer<4> &mux, long jobs)
+{
+	while (jobs-- > 0)
+		co_await next_period();
+	mux.stop();
+}
+
+static void usage(const char *error)
+{
+	fprintf(stderr, "Error: %s\n", error);
+	fprintf(stderr,
+		"Usage: coro_mux [-p CPU] DURATION\n"
+		"\tDURATION is given in seconds.\n");
+	exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+	multiplexer<4> mux(512, 4);
+	struct rt_task params;
+	int opt, cpu = -1, i;
+	double duration;
+	lt_t base;
+
+	while ((opt = getopt(argc, argv, "p:")) != -1) {
+		switch (opt) {
+		case 'p':
+			cpu = atoi(optarg);
+			break;
+		default:
+			usage("Bad argument.");
+		}
+	}
+	if (argc - optind < 1)
+		usage("DURATION missing.");
+	duration = atof(argv[optind]);
+
+	if (!mux ||
+	    mux.spawn(ms2ns(10), [&] {
+		    return timer(mux, (long) (duration * 100));
+	    }) < 0 ||
+	    mux.spawn(ms2ns(10), [] { return sampler(10000); }) < 0 ||
+	    mux.spawn(ms2ns(20), [] { return writer(50000, 1000000); }) < 0 ||
+	    mux.spawn(ms2ns(40), [] { return writer(20000, 1000000); }) < 0) {
+		fprintf(stderr, "could not spawn activities\n");
+		return EXIT_FAILURE;
+	}
+	base = mux.base_period();
+
+	if (init_litmus() != 0) {
+		perror("init_litmus");
+		return EXIT_FAILURE;
+	}
+	init_rt_task_param(&params);
+	params.period    = base;
+	params.exec_cost = base / 2;
+	params.relative_deadline = base;
+	if (cpu >= 0) {
+		if (be_migrate_to_domain(cpu) != 0) {
+			perror("be_migrate_to_domain");
+			return EXIT_FAILURE;
+		}
+		params.cpu = domain_to_first_cpu(cpu);
+	}
+	if (set_rt_task_param(gettid(), &params) != 0) {
+		perror("set_rt_task_param");
+		return EXIT_FAILURE;
+	}
+	if (task_mode(LITMUS_RT_TASK) != 0) {
+		perror("task_mode");
+		return EXIT_FAILURE;
+	}
+
+	if (mux.run() != 0)
+		perror("run");
+
+	task_mode(BACKGROUND_TASK);
+
+	printf("# %8s %8s %12s %12s %12s\n",
+	       "JOBS", "MISSES", "MAX_EXEC", "AVG_EXEC", "MAX_RESP");
+	for (i = 0; i < (int) mux.size(); i++) {
+		const activity_stats &s = mux.stats(i);
+		printf("  %8llu %8llu %12llu %12llu %12llu\n",
+		       (unsigned long long) s.jobs,
+		       (unsigned long long) s.misses,
+		       (unsigned long long) s.max_exec,
+		       (unsigned long long) (s.jobs ? s.total_exec / s.jobs : 0),
+		       (unsigned long long) s.max_response);
+	}
+	return 0;
+}
@@ -2,11 +2,12 @@
 #include <stdlib.h>
 #include <unistd.h>
 
-#include "asm/cycles.h"
+#include "litmus.h"
 
 int main(int argc, char** argv)
 {
 	cycles_t t1, t2;
+	uint64_t hz;
 	int secs = 1;
 
 	if (argc > 1) {
@@ -14,15 +15,23 @@ int main(int argc, char** argv)
 		if (secs <= 0)
 			secs = 1;
 	}
+
+	hz = calibrate_cycles(0);
+	if (!hz)
+		perror("calibrate_cycles");
+	printf("invariant counter: %s, calibrated frequency: %llu Hz\n",
+	       cycles_invariant() ? "yes" : "no", (unsigned long long) hz);
+
 	while (1) {
 		t1 = get_cycles();
 		sleep(secs);
 		t2 = get_cycles();
 		t2 -= t1;
-		printf("%.2f/sec  %.2f/msec  %.2f/usec\n",
+		printf("%.2f/sec  %.2f/msec  %.2f/usec  (%llu ns)\n",
 		       t2 / (double) secs,
 		       t2 / (secs * 1000.0),
-		       t2 / (secs * 1000000.0));
+		       t2 / (secs * 1000000.0),
+		       (unsigned long long) cycles_to_ns(t2));
 	}
 	return 0;
 }
@@ -0,0 +1,227 @@
+/* measure_skew.c -- measure cycle counter offsets and drift between CPUs.
+ *
+ * For each pair of CPUs (A, B), one thread is pinned to A and one to B. They
+ * play ping-pong on a shared cache line: A reads its counter (t0) and pings,
+ * B reads its counter (t1) and pongs, A reads its counter again (t2). If the
+ * message latency is symmetric, B's counter is ahead of A's by
+ *
+ *     offset = t1 - (t0 + t2) / 2
+ *
+ * The sample with the shortest round trip bounds the error best, so only that
+ * one is kept. Repeating the measurement after an interval yields the drift.
+ *
+ * The resulting correction table has one line per pair:
+ *
+ *     CPU_A CPU_B OFFSET DRIFT_PPB EPOCH RTT
+ *
+ * A time stamp t taken on CPU_B converts into CPU_A's time base as
+ *
+ *     t - OFFSET - (t - EPOCH) * DRIFT_PPB / 10^9
+ *
+ * where EPOCH is the (CPU_A) time stamp at which OFFSET was measured and RTT
+ * is the best round trip time, i.e., an upper bound on twice the error. All
+ * values are in cycles. Lines starting with '#' are comments.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "litmus.h"
+#include "common.h"
+
+#define OPTSTR "r:n:d:o:a"
+
+#define CACHE_LINE_SIZE 64
+
+/* the line bounced between the two CPUs */
+static struct {
+	volatile unsigned long seq;  /* odd: ping from A, even: pong from B */
+	volatile cycles_t      t1;   /* B's time stamp */
+} __attribute__((aligned(CACHE_LINE_SIZE))) line;
+
+struct pair_measurement {
+	long long offset;
+	cycles_t  epoch;
+	cycles_t  rtt;
+};
+
+struct responder_args {
+	int cpu;
+	int rounds;
+};
+
+static void usage(char *error) {
+	fprintf(stderr, "Error: %s\n", error);
+	fprintf(stderr,
+		"Usage: measure_skew [-r CPU | -a] [-n ROUNDS] [-d SECONDS] "
+		"[-o FILE]\n"
+		"\n"
+		"	-r CPU      measure all CPUs against CPU (default: 0)\n"
+		"	-a          measure all pairs of CPUs\n"
+		"	-n ROUNDS   ping-pong rounds per measurement "
+		"(default: 10000)\n"
+		"	-d SECONDS  interval for drift estimation, 0 to disable "
+		"(default: 1)\n"
+		"	-o FILE     write correction table to FILE "
+		"(default: stdout)\n");
+	exit(EXIT_FAILURE);
+}
+
+/* runs on CPU B */
+static void* responder(void *_args)
+{
+	struct responder_args *args = _args;
+	unsigned long ping;
+	int i;
+
+	if (be_migrate_to_cpu(args->cpu) != 0)
+		bail_out("could not migrate responder");
+
+	for (i = 0; i < args->rounds; i++) {
+		ping = 2 * i + 1;
+		while (line.seq != ping)
+			;
+		line.t1 = get_cycles_ordered();
+		__sync_synchronize();
+		line.seq = ping + 1;
+	}
+	return NULL;
+}
+
+/* a - b as a signed value; on 32-bit ARM, cycles_t is only 32 bits wide, so
+ * the difference must be made signed before it is widened */
+static long long cycles_diff(cycles_t a, cycles_t b)
+{
+	if (sizeof(cycles_t) < sizeof(long long))
+		return (long) (a - b);
+	return (long long) (a - b);
+}
+
+/* runs on CPU A */
+static void measure_once(int cpu_b, int rounds, struct pair_measurement *m)
+{
+	struct responder_args args = {cpu_b, rounds};
+	pthread_t thread;
+	cycles_t t0, t1, t2;
+	int i;
+
+	line.seq = 0;
+	line.t1  = 0;
+	__sync_synchronize();
+
+	if (pthread_create(&thread, NULL, responder, &args) != 0)
+		bail_out("could not create responder thread");
+
+	m->rtt = (cycles_t) -1;
+	for (i = 0; i < rounds; i++) {
+		t0 = get_cycles_ordered();
+		line.seq = 2 * i + 1;
+		while (line.seq != 2 * i + 2)
+			;
+		t2 = get_cycles_ordered();
+		t1 = line.t1;
+		if (t2 - t0 < m->rtt) {
+			m->rtt    = t2 - t0;
+			m->epoch  = t0 + (t2 - t0) / 2;
+			m->offset = cycles_diff(t1, m->epoch);
+		}
+	}
+
+	pthread_join(thread, NULL);
+}
+
+static void measure_pair(FILE *out, int cpu_a, int cpu_b, int rounds,
+			 int drift_secs)
+{
+	struct pair_measurement first, second;
+	long long drift = 0;
+
+	if (be_migrate_to_cpu(cpu_a) != 0)
+		bail_out("could not migrate to reference CPU");
+
+	measure_once(cpu_b, rounds, &first);
+	if (drift_secs > 0) {
+		sleep(drift_secs);
+		measure_once(cpu_b, rounds, &second);
+		drift = (second.offset - first.offset) * 1000000000LL /
+			(long long) (second.epoch - first.epoch);
+	}
+
+	fprintf(out, "%5d %5d %12lld %9lld %20" CYCLES_FMT " %8" CYCLES_FMT "\n",
+		cpu_a, cpu_b, first.offset, drift, first.epoch, first.rtt);
+	fflush(out);
+}
+
+int main(int argc, char** argv)
+{
+	int opt, a, b;
+	int reference = 0;
+	int all_pairs = 0;
+	int rounds = 10000;
+	int drift_secs = 1;
+	int ncpus = num_online_cpus();
+	uint64_t hz;
+	FILE *out = stdout;
+
+	while ((opt = getopt(argc, argv, OPTSTR)) != -1) {
+		switch (opt) {
+		case 'r':
+			reference = atoi(optarg);
+			break;
+		case 'a':
+			all_pairs = 1;
+			break;
+		case 'n':
+			rounds = atoi(optarg);
+			if (rounds <= 0)
+				usage("Invalid number of rounds.");
+			break;
+		case 'd':
+			drift_secs = atoi(optarg);
+			if (drift_secs < 0)
+				usage("Invalid drift interval.");
+			break;
+		case 'o':
+			out = fopen(optarg, "w");
+			if (!out)
+				bail_out("could not open output file");
+			break;
+		case ':':
+			usage("Argument missing.");
+			break;
+		case '?':
+		default:
+			usage("Bad argument.");
+			break;
+		}
+	}
+
+	if (reference < 0 || reference >= ncpus)
+		usage("Invalid reference CPU.");
+	if (ncpus < 2)
+		usage("Need at least two online CPUs.");
+
+	fprintf(out, "# measure_skew correction table\n");
+	hz = calibrate_cycles(0);
+	if (!hz)
+		perror("calibrate_cycles");
+	fprintf(out, "# counter frequency: %llu Hz, invariant: %s\n",
+		(unsigned long long) hz, cycles_invariant() ? "yes" : "no");
+	fprintf(out, "# %3s %5s %12s %9s %20s %8s\n",
+		"A", "B", "OFFSET", "DRIFT_PPB", "EPOCH", "RTT");
+
+	for (a = 0; a < ncpus; a++) {
+		if (!all_pairs && a != reference)
+			continue;
+		for (b = all_pairs ? a + 1 : 0; b < ncpus; b++)
+			if (b != a)
+				measure_pair(out, a, b, rounds, drift_secs);
+	}
+
+	if (out != stdout)
+		fclose(out);
+	return 0;
+}
@@ -0,0 +1,133 @@
+/* measure_wrappers.cpp -- overhead of the C++ wrappers in litmus.hpp.
+ *
+ * Times non-preemptive sections and, if a lock file is given, FMLP lock
+ * and unlock calls, once through the C API and once through the RAII
+ * wrappers. The functions under test are not inlined, so their code can also
+ * be compared directly, e.g., with
+ *
+ *   objdump -d --no-show-raw-insn measure_wrappers | \
+ *       awk '/<raw_np_section/,/^$/'
+ *
+ * Build with 'make measure_wrappers' (requires a C++20 compiler).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "litmus.hpp"
+
+using namespace std::chrono_literals;
+
+static_assert(litmus::to_lt(10ms) == ms2ns(10));
+static_assert(litmus::task_params{.exec_cost = 1ms, .period = 10ms}.valid());
+static_assert(!litmus::task_params{.exec_cost = 11ms, .period = 10ms}.valid());
+static_assert(!litmus::task_params{.exec_cost = 1ms, .period = 10ms,
+				   .priority = 0}.valid());
+static_assert(sizeof(litmus::np_section) == 1);
+static_assert(sizeof(litmus::resource<FMLP_SEM>) == sizeof(int));
+
+static constexpr auto params = litmus::checked(litmus::task_params{
+	.exec_cost = 100ms, .period = 100ms });
+
+static volatile unsigned long counter;
+
+__attribute__((noinline)) static void raw_np_section(void)
+{
+	enter_np();
+	counter = counter + 1;
+	exit_np();
+}
+
+__attribute__((noinline)) static void guarded_np_section(void)
+{
+	litmus::np_section np;
+	counter = counter + 1;
+}
+
+__attribute__((noinline)) static void raw_lock(int od)
+{
+	if (litmus_lock(od) == 0) {
+		counter = counter + 1;
+		litmus_unlock(od);
+	}
+}
+
+__attribute__((noinline)) static void guarded_lock(litmus::resource<FMLP_SEM> &r)
+{
+	litmus::fmlp_lock guard(r);
+	if (guard)
+		counter = counter + 1;
+}
+
+template <typename F>
+static double cycles_per_call(int rounds, F &&fn)
+{
+	cycles_t start, end;
+
+	start = get_cycles();
+	for (int i = 0; i < rounds; i++)
+		fn();
+	end = get_cycles();
+	return (double) (end - start) / rounds;
+}
+
+static void report(const char *what, double raw, double wrapped)
+{
+	printf("%-16s %12.1f %12.1f %+11.1f%%\n", what, raw, wrapped,
+	       raw ? 100.0 * (wrapped - raw) / raw : 0.0);
+}
+
+int main(int argc, char **argv)
+{
+	int rounds = 1000000, fd = -1;
+
+	if (argc > 1)
+		rounds = atoi(argv[1]);
+	if (argc > 2) {
+		fd = open(argv[2], O_RDONLY | O_CREAT, S_IRUSR | S_IWUSR);
+		if (fd < 0) {
+			perror("open");
+			return EXIT_FAILURE;
+		}
+	}
+	if (rounds <= 0) {
+		fprintf(stderr, "Usage: measure_wrappers [ROUNDS [LOCK_FILE]]\n");
+		return EXIT_FAILURE;
+	}
+
+	if (init_litmus() != 0) {
+		perror("init_litmus");
+		return EXIT_FAILURE;
+	}
+
+	litmus::rt_task_scope rt(params);
+	if (!rt) {
+		perror("rt_task_scope");
+		return EXIT_FAILURE;
+	}
+
+	printf("# %-14s %12s %12s %12s\n", "CYCLES/CALL", "C API", "WRAPPER",
+	       "DIFF");
+	/* warm up caches and the control page */
+	cycles_per_call(rounds / 10 + 1, raw_np_section);
+	report("np section",
+	       cycles_per_call(rounds, raw_np_section),
+	       cycles_per_call(rounds, guarded_np_section));
+
+	if (fd >= 0) {
+		litmus::resource<FMLP_SEM> sem(fd, 0);
+		if (!sem) {
+			perror("open FMLP lock");
+			return EXIT_FAILURE;
+		}
+		cycles_per_call(rounds / 10 + 1,
+				[&] { raw_lock(sem.descriptor()); });
+		report("FMLP lock",
+		       cycles_per_call(rounds,
+				       [&] { raw_lock(sem.descriptor()); }),
+		       cycles_per_call(rounds, [&] { guarded_lock(sem); }));
+		close(fd);
+	}
+	return 0;
+}
@@ -1,9 +1,14 @@
 #include <sys/time.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
 #include <math.h>
 
+/* compare_wrappers() measures the inline system calls */
+#define LITMUS_INLINE_SYSCALLS
 #include "litmus.h"
 
 static void time_null_call(void)
@@ -25,6 +30,36 @@ static void time_null_call(void)
 	       t0, t1, t2, t1 - t0, t2 - t1, t2 - t0);
 }
 
+#define BENCH(label, rounds, call) do { \
+		cycles_t __start, __end; \
+		int __i; \
+		__start = get_cycles(); \
+		for (__i = 0; __i < (rounds); __i++) \
+			call; \
+		__end = get_cycles(); \
+		printf("%-24s %12.1f\n", label, \
+		       (double) (__end - __start) / (rounds)); \
+	} while (0)
+
+/* Compare the inline system call stubs and the cached thread ID with the
+ * out-of-line wrappers and plain system calls. */
+static void compare_wrappers(int rounds)
+{
+	cycles_t ts;
+	unsigned int job_no;
+
+	printf("# %-22s %12s\n", "CALL", "CYCLES");
+	BENCH("syscall(SYS_gettid)", rounds, syscall(SYS_gettid));
+	BENCH("gettid() [cached]", rounds, gettid());
+	BENCH("(null_call)()", rounds, (null_call)(&ts));
+	BENCH("null_call()", rounds, null_call(&ts));
+	BENCH("(get_job_no)()", rounds, (get_job_no)(&job_no));
+	BENCH("get_job_no()", rounds, get_job_no(&job_no));
+#ifndef LITMUS_RAW_SYSCALLS
+	printf("# no inline system calls on this architecture\n");
+#endif
+}
+
 static struct timespec sec2timespec(double seconds)
 {
 	struct timespec tspec;
@@ -39,7 +74,14 @@ int main(int argc, char **argv)
 	double delay;
 	struct timespec sleep_time;
 	
-	if (argc == 2) {
+	if (argc == 3 && !strcmp(argv[1], "-b")) {
+		if (atoi(argv[2]) <= 0) {
+			fprintf(stderr, "Invalid number of rounds: %s\n",
+				argv[2]);
+			return 1;
+		}
+		compare_wrappers(atoi(argv[2]));
+	} else if (argc == 2) {
 		delay = atof(argv[1]);
 		sleep_time = sec2timespec(delay);
 		if (delay <= 0.0)
@@ -6,10 +6,13 @@
 #include <time.h>
 #include <string.h>
 #include <assert.h>
+#include <sched.h>
 
 
 #include "litmus.h"
 #include "common.h"
+#include "irq_stats.h"
+#include "numa.h"
 
 
 
@@ -25,8 +28,12 @@ static void usage(char *error) {
 		"              [-p PARTITION/CLUSTER [-z CLUSTER SIZE]] [-c CLASS]\n"
 		"              [-X LOCKING-PROTOCOL] [-L CRITICAL SECTION LENGTH] [-Q RESOURCE-ID]"
 		"\n"
+		"              [-r] [-N]\n"
 		"WCET and PERIOD are milliseconds, DURATION is seconds.\n"
-		"CRITICAL SECTION LENGTH is in milliseconds.\n");
+		"CRITICAL SECTION LENGTH is in milliseconds.\n"
+		"-r reports interrupts during jobs and the system call entry latency.\n"
+		"-N moves the memory of the task to the NUMA node of the partition or\n"
+		"   cluster given with -p and reports remote pages before and after.\n");
 	exit(EXIT_FAILURE);
 }
 
@@ -110,20 +117,20 @@ static int loop_once(void)
 	return j;
 }
 
-static int loop_for(double exec_time, double emergency_exit)
+static int loop_for(lt_t exec_time, lt_t emergency_exit)
 {
-	double last_loop = 0, loop_start;
+	lt_t last_loop = 0, loop_start;
 	int tmp = 0;
 
-	double start = cputime();
-	double now = cputime();
+	lt_t start = thread_cputime_ns();
+	lt_t now = start;
 
 	while (now + last_loop < start + exec_time) {
 		loop_start = now;
 		tmp += loop_once();
-		now = cputime();
+		now = thread_cputime_ns();
 		last_loop = now - loop_start;
-		if (emergency_exit && wctime() > emergency_exit) {
+		if (emergency_exit && monotonic_ns() > emergency_exit) {
 			/* Oops --- this should only be possible if the execution time tracking
 			 * is broken in the LITMUS^RT kernel. */
 			fprintf(stderr, "!!! rtspin/%d emergency exit!\n", getpid());
@@ -138,53 +145,156 @@ static int loop_for(double exec_time, double emergency_exit)
 
 static void debug_delay_loop(void)
 {
-	double start, end, delay;
+	lt_t start, end, delay;
+	double delta;
 
 	while (1) {
-		for (delay = 0.5; delay > 0.01; delay -= 0.01) {
-			start = wctime();
+		for (delay = ms2ns(500); delay > ms2ns(10); delay -= ms2ns(10)) {
+			start = monotonic_ns();
 			loop_for(delay, 0);
-			end = wctime();
+			end = monotonic_ns();
+			delta = (double) end - start - delay;
 			printf("%6.4fs: looped for %10.8fs, delta=%11.8fs, error=%7.4f%%\n",
-			       delay,
-			       end - start,
-			       end - start - delay,
-			       100 * (end - start - delay) / delay);
+			       delay / 1E9,
+			       (end - start) / 1E9,
+			       delta / 1E9,
+			       100 * delta / delay);
 		}
 	}
 }
 
-static int job(double exec_time, double program_end, int lock_od, double cs_length)
+/* CPUs on which jobs started or completed; under global and clustered
+ * plugins, the CPU after the switch to background mode says nothing about
+ * where the jobs ran */
+static unsigned long long job_cpus;
+
+static void note_job_cpu(void)
 {
-	double chunk1, chunk2;
+	int cpu = sched_getcpu();
+
+	if (cpu >= 0 && cpu < 64)
+		job_cpus |= 1ULL << cpu;
+}
 
-	if (wctime() > program_end)
+static int job(lt_t exec_time, lt_t program_end, int lock_od, lt_t cs_length,
+	       struct irq_stats *irq)
+{
+	lt_t chunk1, chunk2;
+
+	if (monotonic_ns() > program_end)
 		return 0;
 	else {
+		if (irq) {
+			note_job_cpu();
+			irq_job_begin(irq);
+		}
 		if (lock_od >= 0) {
 			/* simulate critical section somewhere in the middle */
+			if (cs_length > exec_time)
+				cs_length = exec_time;
 			chunk1 = drand48() * (exec_time - cs_length);
 			chunk2 = exec_time - cs_length - chunk1;
 
 			/* non-critical section */
-			loop_for(chunk1, program_end + 1);
+			loop_for(chunk1, program_end + s2ns(1));
 
 			/* critical section */
 			litmus_lock(lock_od);
-			loop_for(cs_length, program_end + 1);
+			loop_for(cs_length, program_end + s2ns(1));
 			litmus_unlock(lock_od);
 
 			/* non-critical section */
-			loop_for(chunk2, program_end + 2);
+			loop_for(chunk2, program_end + s2ns(2));
 		} else {
-			loop_for(exec_time, program_end + 1);
+			loop_for(exec_time, program_end + s2ns(1));
+		}
+		if (irq) {
+			irq_job_end(irq);
+			note_job_cpu();
 		}
 		sleep_next_period();
 		return 1;
 	}
 }
 
-#define OPTSTR "p:c:wlveo:f:s:q:X:L:Q:"
+static void move_memory_to_domain(int domain)
+{
+	struct numa_page_stats before, after;
+	int node = domain_to_node(domain);
+
+	if (node < 0) {
+		fprintf(stderr, "Warning: domain %d spans several NUMA nodes, "
+			"memory not moved.\n", domain);
+		return;
+	}
+	if (count_process_pages(NULL, node, &before) != 0)
+		bail_out("could not read the NUMA placement of pages");
+	if (migrate_memory_to_node(node, NUMA_MEM_MIGRATE) != 0)
+		bail_out("could not move memory to the NUMA node");
+	if (count_process_pages(NULL, node, &after) != 0)
+		bail_out("could not read the NUMA placement of pages");
+	printf("# rtspin/%d: NUMA node %d, remote pages %ld of %ld before, "
+	       "%ld of %ld after\n", getpid(), node, before.remote,
+	       before.pages, after.remote, after.pages);
+}
+
+/* Estimate the cost of an IRQ on the task's CPU before it becomes a
+ * real-time task, so that the measurement neither uses up jobs nor delays
+ * the synchronous release. At the highest SCHED_FIFO priority, the
+ * busy-wait is not preempted by other Linux tasks. */
+#define IRQ_CALIBRATION ms2ns(200)
+
+static lt_t calibrate_irq_cost_fifo(void)
+{
+	struct sched_param fifo, normal;
+	lt_t cost;
+
+	memset(&normal, 0, sizeof(normal));
+	fifo.sched_priority = sched_get_priority_max(SCHED_FIFO);
+	if (sched_setscheduler(getpid(), SCHED_FIFO, &fifo) != 0)
+		fprintf(stderr, "Warning: could not become SCHED_FIFO task, "
+			"IRQ cost may include preemptions.\n");
+	cost = calibrate_irq_cost(IRQ_CALIBRATION);
+	sched_setscheduler(getpid(), SCHED_OTHER, &normal);
+	return cost;
+}
+
+static void report_irqs(const struct irq_stats *irq)
+{
+	struct syscall_entry_stats sc;
+	int cpu, first = 1;
+
+	printf("# rtspin/%d, jobs ran on CPU ", getpid());
+	for (cpu = 0; cpu < 64; cpu++)
+		if (job_cpus & (1ULL << cpu)) {
+			printf("%s%d", first ? "" : ",", cpu);
+			first = 0;
+		}
+	printf("%s\n", first ? "(none)" : "");
+	printf("jobs hit by IRQs:    %llu of %llu\n",
+	       (unsigned long long) irq->jobs_hit,
+	       (unsigned long long) irq->jobs);
+	printf("IRQs during jobs:    %llu (at most %llu per job)\n",
+	       (unsigned long long) irq->irqs,
+	       (unsigned long long) irq->max_irqs);
+	printf("est. cost per IRQ:   %llu ns\n",
+	       (unsigned long long) irq->irq_cost);
+	printf("est. time lost:      %llu ns (at most %llu ns per job)\n",
+	       (unsigned long long) irq->lost_total,
+	       (unsigned long long) irq->lost_max);
+
+	if (measure_syscall_entry(&sc, 1000) != 0) {
+		perror("measure_syscall_entry");
+		return;
+	}
+	printf("syscall entry:       min %" CYCLES_FMT ", avg %" CYCLES_FMT
+	       ", max %" CYCLES_FMT " cycles (%llu samples, %llu disturbed)\n",
+	       sc.min, sc.samples ? sc.total / (cycles_t) sc.samples : 0,
+	       sc.max, (unsigned long long) sc.samples,
+	       (unsigned long long) sc.disturbed);
+}
+
+#define OPTSTR "p:c:wlveo:f:s:q:X:L:Q:rN"
 int main(int argc, char** argv)
 {
 	int ret;
@@ -193,6 +303,7 @@ int main(int argc, char** argv)
 	double wcet_ms, period_ms;
 	unsigned int priority = LITMUS_LOWEST_PRIORITY;
 	int migrate = 0;
+	int numa = 0;
 	int cluster = 0;
 	int opt;
 	int wait = 0;
@@ -200,12 +311,14 @@ int main(int argc, char** argv)
 	int column = 1;
 	const char *file = NULL;
 	int want_enforcement = 0;
-	double duration = 0, start = 0;
+	double duration = 0;
+	lt_t start, end;
 	double *exec_times = NULL;
 	double scale = 1.0;
 	task_class_t class = RT_CLASS_HARD;
 	int cur_job = 0, num_jobs = 0;
 	struct rt_task param;
+	struct irq_stats irq_stats, *irq = NULL;
 
 	/* locking */
 	int lock_od = -1;
@@ -265,6 +378,12 @@ int main(int argc, char** argv)
 			if (resource_id <= 0 && strcmp(optarg, "0"))
 				usage("Invalid resource ID.");
 			break;
+		case 'r':
+			irq = &irq_stats;
+			break;
+		case 'N':
+			numa = 1;
+			break;
 		case ':':
 			usage("Argument missing.");
 			break;
@@ -275,6 +394,9 @@ int main(int argc, char** argv)
 		}
 	}
 
+	if (numa && !migrate)
+		usage("-N requires -p.");
+
 	if (test_loop) {
 		debug_delay_loop();
 		return 0;
@@ -325,6 +447,8 @@ int main(int argc, char** argv)
 		ret = be_migrate_to_domain(cluster);
 		if (ret < 0)
 			bail_out("could not migrate to target partition or cluster.");
+		if (numa)
+			move_memory_to_domain(cluster);
 	}
 
 	init_rt_task_param(&param);
@@ -342,6 +466,9 @@ int main(int argc, char** argv)
 
 	init_litmus();
 
+	if (irq && init_irq_stats(irq, calibrate_irq_cost_fifo()) != 0)
+		bail_out("could not map the control page");
+
 	ret = task_mode(LITMUS_RT_TASK);
 	if (ret != 0)
 		bail_out("could not become RT task");
@@ -361,26 +488,29 @@ int main(int argc, char** argv)
 			bail_out("wait_for_ts_release()");
 	}
 
-	start = wctime();
+	start = monotonic_ns();
+	end = start + (lt_t) (duration * 1E9);
 
 	if (file) {
 		/* use times read from the CSV file */
 		for (cur_job = 0; cur_job < num_jobs; ++cur_job) {
-			/* convert job's length to seconds */
-			job(exec_times[cur_job] * 0.001 * scale,
-			    start + duration,
-			    lock_od, cs_length * 0.001);
+			/* convert job's length to nanoseconds */
+			job((lt_t) (exec_times[cur_job] * scale * 1E6),
+			    end, lock_od, (lt_t) (cs_length * 1E6), irq);
 		}
 	} else {
-		/* convert to seconds and scale */
-		while (job(wcet_ms * 0.001 * scale, start + duration,
-			   lock_od, cs_length * 0.001));
+		/* convert to nanoseconds and scale */
+		while (job((lt_t) (wcet_ms * scale * 1E6), end,
+			   lock_od, (lt_t) (cs_length * 1E6), irq));
 	}
 
 	ret = task_mode(BACKGROUND_TASK);
 	if (ret != 0)
 		bail_out("could not become regular task (huh?)");
 
+	if (irq)
+		report_irqs(irq);
+
 	if (file)
 		free(exec_times);
 
@@ -0,0 +1,157 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "litmus.h"
+#include "irq_shield.h"
+#include "common.h"
+
+#define MAX_CPUS 4096
+
+static void usage(char *error)
+{
+	fprintf(stderr, "Error: %s\n", error);
+	fprintf(stderr,
+		"Usage:\n"
+		"	shield_irqs [OPTIONS] DOMAIN...\n"
+		"	shield_irqs [OPTIONS] -c CPUMASK\n"
+		"	shield_irqs [-R PROC] -r FILE\n"
+		"	shield_irqs [-R PROC] [-i SECONDS] -m\n"
+		"\n"
+		"Moves interrupts off the CPUs of the given LITMUS^RT domains\n"
+		"(or of the hexadecimal CPUMASK) and reports the interrupt rate\n"
+		"of each CPU before and after.\n"
+		"\n"
+		"OPTIONS = [-R PROC] [-i SECONDS] [-s FILE]\n"
+		"	-R PROC     use PROC instead of /proc\n"
+		"	-i SECONDS  measure rates over SECONDS (default: 1)\n"
+		"	-s FILE     save the affinities to FILE before changing them\n"
+		"	-r FILE     restore affinities saved with -s\n"
+		"	-m          only report the interrupt rates\n");
+	exit(EXIT_FAILURE);
+}
+
+/* interrupts per second on each CPU; returns the number of CPUs */
+static int measure_rates(const char *root, double interval, double *rates)
+{
+	static uint64_t before[MAX_CPUS], after[MAX_CPUS];
+	struct timespec ts;
+	int i, n;
+
+	ts.tv_sec  = (time_t) interval;
+	ts.tv_nsec = (long) ((interval - ts.tv_sec) * 1E9);
+
+	if (read_irq_counts(root, before, MAX_CPUS) < 0)
+		return -1;
+	nanosleep(&ts, NULL);
+	n = read_irq_counts(root, after, MAX_CPUS);
+	for (i = 0; i < n; i++)
+		rates[i] = after[i] >= before[i] ?
+			(after[i] - before[i]) / interval : 0;
+	return n;
+}
+
+static void print_result(const char *what, const struct irq_shield_result *r)
+{
+	printf("# %s: %d changed, %d unchanged, %d failed\n",
+	       what, r->changed, r->unchanged, r->failed);
+}
+
+int main(int argc, char** argv)
+{
+	static double rates_before[MAX_CPUS], rates_after[MAX_CPUS];
+	struct irq_shield_result result;
+	const char *root = NULL, *save = NULL, *restore = NULL;
+	unsigned long long cpus = 0, mask;
+	int opt, i, n, ndomains, domain, measure_only = 0, have_cpus = 0;
+	int ret = EXIT_SUCCESS;
+	double interval = 1.0;
+	FILE *f;
+
+	while ((opt = getopt(argc, argv, "R:i:s:r:c:m")) != -1) {
+		switch (opt) {
+		case 'R':
+			root = optarg;
+			break;
+		case 'i':
+			interval = atof(optarg);
+			if (interval <= 0)
+				usage("Invalid interval.");
+			break;
+		case 's':
+			save = optarg;
+			break;
+		case 'r':
+			restore = optarg;
+			break;
+		case 'c':
+			cpus = strtoull(optarg, NULL, 16);
+			have_cpus = 1;
+			break;
+		case 'm':
+			measure_only = 1;
+			break;
+		default:
+			usage("Bad argument.");
+		}
+	}
+
+	if (restore) {
+		f = fopen(restore, "r");
+		if (!f)
+			bail_out("could not open snapshot");
+		if (restore_irq_affinity(root, f, &result) != 0)
+			ret = EXIT_FAILURE;
+		fclose(f);
+		print_result("restored", &result);
+		return ret;
+	}
+
+	if (!measure_only) {
+		ndomains = argc - optind;
+		if (!have_cpus && !ndomains)
+			usage("No domain or CPU mask given.");
+		for (i = 0; i < ndomains; i++) {
+			domain = atoi(argv[optind + i]);
+			if (domain_to_cpus(domain, &mask) != 0)
+				usage("Unknown domain.");
+			cpus |= mask;
+		}
+		if (!cpus)
+			usage("No CPUs to shield.");
+	}
+
+	n = measure_rates(root, interval, rates_before);
+	if (n < 0)
+		bail_out("could not read interrupt counts");
+
+	if (!measure_only) {
+		if (save) {
+			f = fopen(save, "w");
+			if (!f || save_irq_affinity(root, f) != 0)
+				bail_out("could not save affinities");
+			fclose(f);
+		}
+		if (irq_shield_cpus(root, cpus, &result) != 0)
+			ret = EXIT_FAILURE;
+		print_result("shielded", &result);
+		if (measure_rates(root, interval, rates_after) < 0)
+			bail_out("could not read interrupt counts");
+	}
+
+	printf("# %4s %12s", "CPU", "IRQS/S");
+	if (!measure_only)
+		printf(" %12s %8s", "AFTER", "SHIELDED");
+	printf("\n");
+	for (i = 0; i < n; i++) {
+		printf("  %4d %12.1f", i, rates_before[i]);
+		if (!measure_only)
+			printf(" %12.1f %8s", rates_after[i],
+			       i < 64 && (cpus & (1ULL << i)) ? "yes" : "");
+		printf("\n");
+	}
+	return ret;
+}
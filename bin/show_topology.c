@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "litmus.h"
+#include "common.h"
+#include "topology.h"
+
+static void usage(char *error)
+{
+	fprintf(stderr, "Error: %s\n", error);
+	fprintf(stderr,
+		"Usage: show_topology [-R SYSFS]\n"
+		"\n"
+		"Lists the CPUs that share each cache level and NUMA node,\n"
+		"recommends cluster sizes, and checks the LITMUS^RT domains\n"
+		"of the running system against the topology.\n"
+		"	-R SYSFS  use SYSFS instead of /sys\n");
+	exit(EXIT_FAILURE);
+}
+
+static void print_cpus(unsigned long long cpus)
+{
+	int cpu, first = 1;
+
+	for (cpu = 0; cpu < TOPOLOGY_MAX_CPUS; cpu++)
+		if (cpus & (1ULL << cpu)) {
+			printf("%s%d", first ? "" : ",", cpu);
+			first = 0;
+		}
+}
+
+static void print_groups(const struct cpu_topology *t, int level)
+{
+	unsigned long long groups[TOPOLOGY_MAX_CPUS];
+	int i, n;
+
+	n = topology_groups(t, level, groups, TOPOLOGY_MAX_CPUS);
+	if (!n)
+		return;
+	if (level)
+		printf("L%d:  ", level);
+	else
+		printf("node:");
+	for (i = 0; i < n && i < TOPOLOGY_MAX_CPUS; i++) {
+		printf(" {");
+		print_cpus(groups[i]);
+		printf("}");
+	}
+	printf("\n");
+}
+
+static void check_domains(const struct cpu_topology *t)
+{
+	unsigned long long cpus;
+	int domain, level, split;
+
+	/* without LITMUS^RT, there are no domains to check */
+	for (domain = 0; domain_to_cpus(domain, &cpus) == 0; domain++) {
+		if (domain == 0)
+			printf("# LITMUS^RT domains\n");
+		level = shared_cache_level(t, cpus);
+		split = split_cache_level(t, cpus);
+		printf("domain %d: {", domain);
+		print_cpus(cpus);
+		printf("}");
+		if (level)
+			printf(" shares L%d", level);
+		if (split)
+			printf(" STRADDLES L%d caches", split);
+		else if (!level && __builtin_popcountll(cpus) > 1)
+			printf(" STRADDLES caches (no shared cache)");
+		if (spans_nodes(t, cpus))
+			printf(" STRADDLES NUMA nodes");
+		printf("\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	struct cpu_topology t;
+	struct cluster_advice advice[TOPOLOGY_MAX_ADVICE];
+	const char *root = NULL;
+	int opt, i, n, level;
+
+	while ((opt = getopt(argc, argv, "R:")) != -1) {
+		switch (opt) {
+		case 'R':
+			root = optarg;
+			break;
+		default:
+			usage("Bad argument.");
+		}
+	}
+
+	if (read_cpu_topology(root, &t) != 0)
+		bail_out("could not read the CPU topology");
+
+	printf("# CPUs sharing a cache or node\n");
+	for (level = 1; level <= t.levels; level++)
+		print_groups(&t, level);
+	print_groups(&t, 0);
+
+	printf("# recommended cluster sizes\n");
+	n = recommend_cluster_sizes(&t, advice, TOPOLOGY_MAX_ADVICE);
+	for (i = 0; i < n; i++)
+		printf("%3d CPUs x %2d clusters  (%s)\n", advice[i].size,
+		       advice[i].nclusters, advice[i].why);
+
+	check_domains(&t);
+	return 0;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file arena.h
+ * Real-time safe memory allocation from prefaulted, locked regions
+ *
+ * An arena reserves, prefaults, and locks a region up front. Afterwards,
+ * allocations are served by bumping a pointer, without locks, page faults,
+ * or system calls. Arenas are not thread-safe; each thread should use its
+ * own (see set_thread_arena()). Pools hand out fixed-size objects from an
+ * arena and support freeing individual objects.
+ *
+ * The high-water marks tell how much memory a job actually needed, which
+ * allows sizing arenas such that init_litmus_flags(LITMUS_NO_MLOCKALL) can be
+ * used on memory-constrained systems.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h> /* for size_t */
+
+/**
+ * Alignment of all arena allocations
+ */
+#define RT_ARENA_ALIGN 16
+
+/**
+ * Bump-pointer arena backed by locked memory
+ */
+struct rt_arena {
+	char*  base;       /**< Start of the region */
+	size_t size;       /**< Size of the region in bytes */
+	size_t used;       /**< Bytes currently allocated */
+	size_t high_water; /**< Maximum of used since initialisation */
+};
+
+/**
+ * Pool of fixed-size objects backed by an arena
+ */
+struct rt_pool {
+	struct rt_arena arena; /**< @private Backing memory */
+	void*  free_list;      /**< @private Singly-linked list of free objects */
+	size_t obj_size;       /**< Size of each object (after alignment) */
+	size_t count;          /**< Number of objects in the pool */
+	size_t in_use;         /**< Objects currently allocated */
+	size_t high_water;     /**< Maximum of in_use since initialisation */
+};
+
+/**
+ * Reserve, prefault, and lock memory for an arena
+ * @param arena Arena to initialise
+ * @param size Size in bytes (rounded up to whole pages)
+ * @return 0 on success, -1 on error (e.g., RLIMIT_MEMLOCK exceeded)
+ */
+int rt_arena_init(struct rt_arena *arena, size_t size);
+/**
+ * Unlock and release the memory of an arena
+ * @param arena Arena initialised with rt_arena_init()
+ */
+void rt_arena_destroy(struct rt_arena *arena);
+/**
+ * Allocate from an arena
+ * @param arena Arena to allocate from
+ * @param size Number of bytes
+ * @return Pointer aligned to RT_ARENA_ALIGN, or NULL if the arena is exhausted
+ */
+void* rt_arena_alloc(struct rt_arena *arena, size_t size);
+/**
+ * Release all allocations of an arena at once (e.g., at the end of a job)
+ * @param arena Arena to reset; the high-water mark is retained
+ */
+void rt_arena_reset(struct rt_arena *arena);
+
+/**
+ * Set up a pool of fixed-size objects in locked memory
+ * @param pool Pool to initialise
+ * @param obj_size Size of each object in bytes
+ * @param count Number of objects
+ * @return 0 on success, -1 on error (errno is EOVERFLOW if the pool's size
+ *         does not fit into a size_t)
+ */
+int rt_pool_init(struct rt_pool *pool, size_t obj_size, size_t count);
+/**
+ * Release the memory of a pool
+ * @param pool Pool initialised with rt_pool_init()
+ */
+void rt_pool_destroy(struct rt_pool *pool);
+/**
+ * Allocate an object from a pool
+ * @param pool Pool to allocate from
+ * @return Pointer to an object, or NULL if all objects are in use
+ */
+void* rt_pool_alloc(struct rt_pool *pool);
+/**
+ * Return an object to its pool
+ * @param pool Pool the object was allocated from
+ * @param obj Object to free (NULL is ignored)
+ */
+void rt_pool_free(struct rt_pool *pool, void *obj);
+
+/**
+ * Select the arena that rt_malloc() uses in the current thread
+ * @param arena Arena owned by the calling thread, or NULL
+ */
+void set_thread_arena(struct rt_arena *arena);
+/**
+ * Obtain the arena used by rt_malloc() in the current thread
+ * @return The thread's arena, or NULL if none is set
+ */
+struct rt_arena* get_thread_arena(void);
+/**
+ * Allocate from the current thread's arena
+ * @param size Number of bytes
+ * @return Pointer to memory, or NULL if there is no arena or it is exhausted
+ */
+void* rt_malloc(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,114 @@
+/**
+ * @file event_task.h
+ * Event-triggered sporadic tasks
+ *
+ * An event task binds a file descriptor (a pipe, socket, eventfd, ...) to a
+ * LITMUS^RT sporadic task: each job waits for the descriptor to become
+ * readable and then invokes a handler. Releases are separated by at least
+ * the task's period, no matter how fast events arrive, so the task never
+ * exceeds the load that was accounted for in the schedulability analysis.
+ * Events that arrive too early are delayed to the next permissible release
+ * and handled together (coalesced).
+ */
+
+#ifndef EVENT_TASK_H
+#define EVENT_TASK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "litmus.h"
+
+/**
+ * How events are read from the descriptor
+ */
+enum event_source_mode {
+	/** The handler reads the descriptor itself (pipes, sockets). */
+	EVENT_SOURCE_STREAM,
+	/** The descriptor is an eventfd; the library reads the counter and
+	 *  passes the number of pending events to the handler. */
+	EVENT_SOURCE_EVENTFD,
+};
+
+/**
+ * Event handler
+ * @param fd The event source
+ * @param events Number of events to handle (EVENT_SOURCE_EVENTFD), or 0 if
+ *        unknown (EVENT_SOURCE_STREAM)
+ * @param arg User argument given to init_event_task()
+ * @return 0 to keep waiting for events, non-zero to stop
+ */
+typedef int (*event_handler_t)(int fd, uint64_t events, void *arg);
+
+/**
+ * Statistics of an event task
+ */
+struct event_stats {
+	uint64_t jobs;      /**< Handler invocations */
+	uint64_t events;    /**< Events received (EVENT_SOURCE_EVENTFD only) */
+	uint64_t coalesced; /**< Events handled by a job together with an
+			     *   earlier event (EVENT_SOURCE_EVENTFD only) */
+	uint64_t dropped;   /**< Events discarded because a job was limited to
+			     *   max_events (EVENT_SOURCE_EVENTFD only) */
+	uint64_t delayed;   /**< Jobs whose events were pending already when
+			     *   the previous job completed, or whose start
+			     *   was held back to enforce the minimum
+			     *   inter-arrival time */
+	lt_t     max_delay; /**< Longest time that a job's start was held
+			     *   back to enforce the minimum inter-arrival
+			     *   time, in nanoseconds */
+};
+
+/**
+ * State of an event task
+ */
+struct event_task {
+	int fd;                  /**< Event source */
+	enum event_source_mode mode; /**< How events are read */
+	event_handler_t handler; /**< Invoked once per job */
+	void* arg;               /**< Argument for handler */
+	uint64_t max_events;     /**< EVENT_SOURCE_EVENTFD: maximum events
+				  *   passed to one job, excess events are
+				  *   dropped; 0 for no limit */
+	lt_t min_interarrival;   /**< Minimum separation of job starts, taken
+				  *   from the task's period */
+	struct event_stats stats; /**< Statistics */
+	lt_t last_start;         /**< @private */
+};
+
+/**
+ * Initialise an event task for the calling thread
+ * @param et Event task to initialise
+ * @param fd Event source
+ * @param mode How events are read from fd
+ * @param handler Invoked once per job
+ * @param arg Argument for handler
+ * @return 0 on success, -1 with errno set to EINVAL if the calling thread
+ *         is not configured as a sporadic task (release_policy
+ *         TASK_SPORADIC), or on other errors
+ *
+ * Must be called after set_rt_task_param().
+ */
+int init_event_task(struct event_task *et, int fd,
+		    enum event_source_mode mode, event_handler_t handler,
+		    void *arg);
+
+/**
+ * Handle events until the handler asks to stop
+ * @param et Event task initialised with init_event_task()
+ * @return 0 if the handler asked to stop, -1 on error (e.g., if the event
+ *         source was closed)
+ *
+ * The calling thread must be a real-time task. Each job ends with
+ * sleep_next_period(), which lets the kernel enforce the minimum
+ * separation of releases; it is also enforced in user space, as a task
+ * that self-suspends past its deadline may otherwise be released early.
+ */
+int run_event_task(struct event_task *et);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * @file exec_estimator.h
+ * Online execution-time estimation and budget recommendations
+ *
+ * An estimator consumes the CPU time of each job and maintains three
+ * estimates side by side: a streaming quantile (P-square algorithm, constant
+ * memory and time per sample), an exponentially weighted moving average,
+ * and the observed maximum. A budget policy turns one of them into a
+ * recommended exec_cost, which the task can apply between jobs with
+ * apply_exec_cost() or automatically via a job runner.
+ */
+
+#ifndef EXEC_ESTIMATOR_H
+#define EXEC_ESTIMATOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "litmus.h"
+
+/**
+ * Streaming execution-time estimator
+ */
+struct exec_estimator {
+	double   quantile;   /**< Quantile tracked by the sketch, in (0, 1) */
+	unsigned int ewma_shift; /**< EWMA weight of a new sample is 2^-shift */
+	uint64_t samples;    /**< Number of samples consumed */
+	lt_t     max;        /**< Largest sample */
+	lt_t     ewma;       /**< Moving average */
+	double   q[5];       /**< @private P-square marker heights */
+	int      n[5];       /**< @private P-square marker positions */
+	double   np[5];      /**< @private Desired marker positions */
+};
+
+/**
+ * Which estimate a budget policy is based on
+ */
+enum exec_estimate {
+	EXEC_EST_QUANTILE, /**< The estimator's quantile */
+	EXEC_EST_EWMA,     /**< The moving average */
+	EXEC_EST_MAX,      /**< The observed maximum */
+};
+
+/**
+ * Flags of a budget policy
+ */
+enum exec_budget_flags {
+	/** Let a job runner apply recommendations with apply_exec_cost() */
+	EXEC_BUDGET_APPLY     = 0x1,
+	/** Never recommend a smaller budget than the current one */
+	EXEC_BUDGET_NO_SHRINK = 0x2,
+	/** Never recommend a larger budget than the current one */
+	EXEC_BUDGET_NO_GROW   = 0x4,
+};
+
+/**
+ * Rules for turning an estimate into a recommended exec_cost
+ */
+struct exec_budget_policy {
+	enum exec_estimate estimate; /**< Estimate to start from */
+	unsigned int margin_pct;     /**< Headroom added to the estimate, in
+				      *   percent of the estimate */
+	unsigned int hysteresis_pct; /**< Keep the current budget unless the
+				      *   recommendation differs by more than
+				      *   this percentage */
+	unsigned int warmup;         /**< Samples needed before the first
+				      *   recommendation */
+	lt_t min_budget;             /**< Lower bound on recommendations */
+	lt_t max_budget;             /**< Upper bound on recommendations,
+				      *   0 for none */
+	int  flags;                  /**< enum exec_budget_flags */
+};
+
+/**
+ * Initialise an estimator
+ * @param est Estimator to initialise
+ * @param quantile Quantile to track, e.g., 0.99
+ * @param ewma_shift The moving average gives a weight of 2^-ewma_shift to
+ *        each new sample
+ */
+void init_exec_estimator(struct exec_estimator *est, double quantile,
+			 unsigned int ewma_shift);
+
+/**
+ * Add the execution time of a job to an estimator
+ * @param est Estimator
+ * @param exec_time CPU time consumed by the job in nanoseconds
+ */
+void exec_estimator_add(struct exec_estimator *est, lt_t exec_time);
+
+/**
+ * Obtain the current quantile estimate
+ * @param est Estimator
+ * @return Estimated quantile in nanoseconds, 0 if there are no samples yet
+ */
+lt_t exec_estimate_quantile(const struct exec_estimator *est);
+
+/**
+ * Recommend an execution-time budget
+ * @param est Estimator
+ * @param policy Policy to apply
+ * @param current Currently configured exec_cost
+ * @return Recommended exec_cost; equal to current if the estimator has not
+ *         warmed up yet or the change would be within the hysteresis band
+ */
+lt_t recommend_exec_cost(const struct exec_estimator *est,
+			 const struct exec_budget_policy *policy,
+			 lt_t current);
+
+/**
+ * Change the execution-time budget of the calling task
+ * @param exec_cost New exec_cost in nanoseconds
+ * @return 0 on success, -1 on error
+ *
+ * LITMUS^RT refuses parameter changes while a task is in real-time mode, so
+ * a real-time caller briefly returns to background mode to apply the change.
+ * Re-entering real-time mode releases a new job immediately, i.e., the
+ * task's release sequence restarts. Call this only between jobs.
+ */
+int apply_exec_cost(lt_t exec_cost);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file fork_join.h
+ * Fork-join parallel jobs across the CPUs of a domain
+ *
+ * A fork-join task consists of one real-time worker thread per CPU of a
+ * domain (cluster). All workers share the task's period and deadline and are
+ * released together. In each job, every worker executes its share of the
+ * work and then waits for the others at a barrier, so a job is complete once
+ * the last worker is done. This allows jobs whose total execution time
+ * exceeds their deadline, as long as their work can be split across the
+ * CPUs of a cluster (federated scheduling).
+ *
+ * Like rt_thread.h, this header is not included by litmus.h.
+ */
+
+#ifndef FORK_JOIN_H
+#define FORK_JOIN_H
+
+#include "rt_thread.h"
+
+/**
+ * Size of a cache line; statistics of different workers are kept apart
+ */
+#define FORK_JOIN_CACHE_LINE 64
+
+/**
+ * Work function of a fork-join task
+ * @param worker Index of the calling worker, 0 <= worker < nworkers
+ * @param nworkers Number of workers
+ * @param job_no Job number of the current job
+ * @param arg User argument given to fork_join_create()
+ */
+typedef void (*fork_join_fn_t)(int worker, int nworkers,
+			       unsigned int job_no, void *arg);
+
+/**
+ * Per-worker load statistics; written only by the worker itself
+ */
+struct fork_join_worker_stats {
+	uint64_t jobs;       /**< Jobs completed by this worker */
+	lt_t     busy_total; /**< Time spent in the work function */
+	lt_t     busy_max;   /**< Longest time spent in the work function */
+	lt_t     wait_total; /**< Time spent waiting for other workers */
+	lt_t     wait_max;   /**< Longest wait at the barrier */
+	int      cpu;        /**< CPU the worker was assigned to */
+} __attribute__((aligned(FORK_JOIN_CACHE_LINE)));
+
+/**
+ * State of a fork-join task
+ */
+struct fork_join {
+	int nworkers;            /**< Number of workers */
+	fork_join_fn_t work;     /**< Work function */
+	void* arg;               /**< Argument for work */
+	struct fork_join_worker_stats *stats; /**< One entry per worker */
+	uint64_t jobs;           /**< Completed jobs */
+	lt_t     span_total;     /**< Sum of the span (first worker start to
+				  *   last worker completion) of all jobs */
+	lt_t     span_max;       /**< Longest span of a job */
+	volatile int error;      /**< errno of the first worker that failed, 0
+				  *   if none did */
+
+	pthread_t *threads;      /**< @private */
+	void* workers;           /**< @private Per-worker arguments */
+	volatile int stop;       /**< @private */
+	volatile int stopping;   /**< @private Decision published at barrier */
+	volatile int remaining;  /**< @private Workers yet to arrive */
+	volatile int sense;      /**< @private Flipped by the last arrival */
+	volatile lt_t job_start; /**< @private First worker start of the job */
+};
+
+/**
+ * Create and admit the workers of a fork-join task
+ * @param fj Fork-join task to initialise
+ * @param domain Domain whose CPUs the workers are spread across
+ * @param params Task parameters shared by all workers; exec_cost is the
+ *        budget of each worker
+ * @param work Work function
+ * @param arg Argument for work
+ * @return 0 on success, -1 on error
+ *
+ * One worker is created per CPU of the domain, with params.cpu set to that
+ * CPU. The workers are admitted as one batch (see litmus_threads_create())
+ * and then wait for a synchronous release, which must be triggered with
+ * release_ts().
+ */
+int fork_join_create(struct fork_join *fj, int domain,
+		     const struct rt_task *params, fork_join_fn_t work,
+		     void *arg);
+
+/**
+ * Ask the workers of a fork-join task to stop after the current job
+ * @param fj Fork-join task created with fork_join_create()
+ *
+ * Returns immediately; may also be called from within the work function.
+ */
+void fork_join_stop(struct fork_join *fj);
+
+/**
+ * Wait for the workers of a stopped fork-join task to exit
+ * @param fj Fork-join task created with fork_join_create()
+ *
+ * The statistics remain available until fork_join_destroy() is called.
+ * If a worker failed to obtain its job number or to wait for its next
+ * period, all workers have stopped at the end of the current job and error
+ * is set.
+ */
+void fork_join_join(struct fork_join *fj);
+
+/**
+ * Release the resources of a joined fork-join task
+ * @param fj Fork-join task joined with fork_join_join()
+ */
+void fork_join_destroy(struct fork_join *fj);
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef INTERNAL_H
 #define INTERNAL_H
 
+#include <stdint.h>
+
 /* low level operations, not intended for API use */
 
 #define check(str)	 \
@@ -23,8 +25,71 @@
 #define BUILD_BUG_ON_ZERO(e) (sizeof(struct { int:-!!(e); }))
 #define BUILD_BUG_ON(condition) ((void)BUILD_BUG_ON_ZERO(condition))
 
+/* Sequence counter for data that one thread updates and others, possibly in
+ * other processes, read without locks. The writer brackets each update with
+ * seqcount_write_begin() and seqcount_write_end(), so the counter is odd
+ * while an update is in progress. Readers copy the data between
+ * seqcount_read_begin() and seqcount_read_retry(), and start over if the
+ * latter returns true, i.e., if they may have seen a torn update. */
+static inline void seqcount_write_begin(volatile uint64_t *seq)
+{
+	(*seq)++;
+	__sync_synchronize();
+}
+
+static inline void seqcount_write_end(volatile uint64_t *seq)
+{
+	__sync_synchronize();
+	(*seq)++;
+}
+
+static inline uint64_t seqcount_read_begin(const volatile uint64_t *seq)
+{
+	uint64_t start;
+
+	while ((start = *seq) & 1)
+		; /* writer is in the middle of an update */
+	__sync_synchronize();
+	return start;
+}
+
+/* Non-waiting variant of seqcount_read_begin() for readers that must not spin
+ * on a writer that may be preempted: returns false, without waiting, if an
+ * update is in progress. */
+static inline int seqcount_read_try(const volatile uint64_t *seq,
+				    uint64_t *start)
+{
+	*start = *seq;
+	__sync_synchronize();
+	return !(*start & 1);
+}
+
+static inline int seqcount_read_retry(const volatile uint64_t *seq,
+				      uint64_t start)
+{
+	__sync_synchronize();
+	return *seq != start;
+}
+
 /* I/O convenience function */
 ssize_t read_file(const char* fname, void* buf, size_t maxlen);
 
+/* Parse a CPU or node list such as "0-3,8,10-11" into a bit mask; IDs of
+ * 64 and above are ignored. */
+unsigned long long parse_cpu_list(const char *list);
+
+/* Map (and create, if necessary) a file of at least size bytes as a
+ * MAP_SHARED region. Returns NULL on failure. */
+void* map_shared_file(const char* filename, size_t size);
+
+/* Replace the parameters of the calling task and, if domain >= 0, move it to
+ * that domain. A task in real-time mode passes through background mode,
+ * which restarts its release sequence. */
+int change_rt_task_param(struct rt_task* param, int domain);
+
+/* Drop the cached mode of the calling thread, e.g., after its scheduling
+ * policy was changed without task_mode(). */
+void forget_task_mode(void);
+
 #endif
 
@@ -0,0 +1,97 @@
+/**
+ * @file irq_shield.h
+ * Steering device interrupts away from real-time CPUs
+ *
+ * Interrupts that land on the CPUs of a partition or cluster delay its
+ * real-time tasks. Linux lets user space choose the CPUs that may handle
+ * each interrupt through /proc/irq/<n>/smp_affinity, and the CPUs for
+ * interrupts that are registered later through
+ * /proc/irq/default_smp_affinity. The functions below clear a set of CPUs
+ * from these masks, save and restore the masks, and read the per-CPU
+ * interrupt counts from /proc/interrupts.
+ *
+ * All functions take the root of the proc file system as their first
+ * argument (NULL for /proc), so that they can work on a copy of the tree.
+ * Changing the affinities requires root privileges. Some interrupts, such
+ * as per-CPU timers, cannot be moved; they are counted as failures.
+ *
+ * This header is not included by litmus.h.
+ */
+
+#ifndef IRQ_SHIELD_H
+#define IRQ_SHIELD_H
+
+#include <stdio.h>
+#include <stdint.h>
+
+/**
+ * Outcome of changing the affinities of all interrupts
+ */
+struct irq_shield_result {
+	int changed;   /**< Masks that were rewritten */
+	int unchanged; /**< Masks that needed no change */
+	int failed;    /**< Masks that could not be read or written */
+};
+
+/**
+ * Keep interrupts off a set of CPUs
+ * @param proc_root Root of the proc file system, or NULL for /proc
+ * @param cpus Bit mask of the CPUs to shield
+ * @param result Where to store what was done, may be NULL
+ * @return 0 if every mask could be changed, -1 otherwise
+ *
+ * The CPUs are removed from the affinity of every interrupt and from the
+ * default affinity. An interrupt whose affinity would become empty is moved
+ * to the new default affinity instead.
+ */
+int irq_shield_cpus(const char *proc_root, unsigned long long cpus,
+		    struct irq_shield_result *result);
+
+/**
+ * Keep interrupts off the CPUs of LITMUS^RT scheduling domains
+ * @param proc_root Root of the proc file system, or NULL for /proc
+ * @param domains Domains (partitions or clusters) to shield
+ * @param ndomains Number of domains
+ * @param result Where to store what was done, may be NULL
+ * @return 0 on success, -1 if a domain is unknown or a mask could not be
+ *         changed
+ *
+ * The CPUs of the domains are looked up with domain_to_cpus() in the
+ * running system, independently of proc_root.
+ */
+int irq_shield_domains(const char *proc_root, const int *domains,
+		       int ndomains, struct irq_shield_result *result);
+
+/**
+ * Save the affinity of every interrupt and the default affinity
+ * @param proc_root Root of the proc file system, or NULL for /proc
+ * @param out Where to write the snapshot to, one "IRQ MASK" line per
+ *        interrupt and a "default MASK" line
+ * @return 0 on success, -1 on error
+ */
+int save_irq_affinity(const char *proc_root, FILE *out);
+
+/**
+ * Restore affinities saved with save_irq_affinity()
+ * @param proc_root Root of the proc file system, or NULL for /proc
+ * @param in Snapshot to read
+ * @param result Where to store what was done, may be NULL
+ * @return 0 if every mask could be restored, -1 otherwise
+ */
+int restore_irq_affinity(const char *proc_root, FILE *in,
+			 struct irq_shield_result *result);
+
+/**
+ * Read the number of interrupts handled by each CPU so far
+ * @param proc_root Root of the proc file system, or NULL for /proc
+ * @param counts Where to store the counts, indexed by CPU
+ * @param max_cpus Number of entries in counts
+ * @return One more than the highest CPU listed in /proc/interrupts, or -1
+ *         on error
+ *
+ * Sums all rows of /proc/interrupts that have a count for each CPU. Counts
+ * of offline CPUs are 0.
+ */
+int read_irq_counts(const char *proc_root, uint64_t *counts, int max_cpus);
+
+#endif
@@ -0,0 +1,110 @@
+/**
+ * @file irq_stats.h
+ * Interrupt interference per job, based on the control page's IRQ counter
+ *
+ * The kernel increments irq_count in a task's control page for every
+ * interrupt that it handles while the task is scheduled. Sampling the
+ * counter at the start and the end of each job shows which jobs were hit by
+ * interrupts and how often; multiplied by an estimate of the cost of one
+ * interrupt (see calibrate_irq_cost()), this estimates the execution time
+ * that each job lost. Tasks on CPUs with many hit jobs are candidates for
+ * moving interrupts elsewhere.
+ *
+ * The control page also lets a task tell the kernel when it issued a system
+ * call (ts_syscall_start and irq_syscall_start), which the kernel's
+ * overhead tracing uses. measure_syscall_entry() fills these fields around
+ * null_call() to measure the system call entry latency directly and to
+ * discard samples disturbed by interrupts.
+ */
+
+#ifndef IRQ_STATS_H
+#define IRQ_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "litmus.h"
+
+/**
+ * Interrupt statistics of the jobs of one task
+ *
+ * Written only by the task itself.
+ */
+struct irq_stats {
+	uint64_t jobs;       /**< Jobs accounted */
+	uint64_t jobs_hit;   /**< Jobs during which at least one IRQ occurred */
+	uint64_t irqs;       /**< IRQs during all jobs */
+	uint64_t max_irqs;   /**< Most IRQs during a single job */
+	lt_t     irq_cost;   /**< Estimated time per IRQ in ns, 0 if unknown */
+	lt_t     lost_total; /**< Estimated time lost to IRQs in all jobs */
+	lt_t     lost_max;   /**< Estimated time lost to IRQs in one job */
+	uint64_t irq_start;  /**< @private Counter at the start of the job */
+};
+
+/**
+ * Initialise interrupt statistics
+ * @param stats Statistics to initialise
+ * @param irq_cost Estimated time per IRQ in nanoseconds, e.g., from
+ *        calibrate_irq_cost(), or 0 to only count IRQs
+ * @return 0 on success, -1 if the control page cannot be mapped
+ */
+int init_irq_stats(struct irq_stats *stats, lt_t irq_cost);
+
+/**
+ * Mark the start of a job
+ * @param stats Statistics initialised with init_irq_stats()
+ */
+void irq_job_begin(struct irq_stats *stats);
+
+/**
+ * Mark the end of a job and account the IRQs that occurred during it
+ * @param stats Statistics initialised with init_irq_stats()
+ * @return Number of IRQs during the job
+ */
+uint64_t irq_job_end(struct irq_stats *stats);
+
+/**
+ * Estimate the time that the CPU spends handling one interrupt
+ * @param duration How long to measure, in nanoseconds
+ * @return Mean time per IRQ in nanoseconds, or 0 if no IRQ occurred or the
+ *         control page cannot be mapped
+ *
+ * Busy-waits for the given duration, reading the clock and the IRQ counter
+ * in a tight loop. Gaps between clock readings during which the counter
+ * advanced, minus the shortest gap, are attributed to interrupts. Timer
+ * ticks alone usually provide enough samples within a few hundred
+ * milliseconds. The result is only meaningful if the calling thread is not
+ * preempted, e.g., if it runs as a real-time task or on an idle CPU.
+ */
+lt_t calibrate_irq_cost(lt_t duration);
+
+/**
+ * System call entry latency in cycles
+ */
+struct syscall_entry_stats {
+	uint64_t samples;   /**< Undisturbed samples */
+	uint64_t disturbed; /**< Samples discarded because an IRQ occurred */
+	cycles_t min;       /**< Shortest entry latency */
+	cycles_t max;       /**< Longest undisturbed entry latency */
+	cycles_t total;     /**< Sum of all undisturbed entry latencies */
+};
+
+/**
+ * Measure how long it takes to enter the kernel
+ * @param stats Where to store the results
+ * @param samples Number of system calls to issue
+ * @return 0 on success, -1 if the control page cannot be mapped or
+ *         null_call() fails
+ *
+ * Before each null_call(), records the cycle counter and the IRQ counter in
+ * the control page's ts_syscall_start and irq_syscall_start fields; the
+ * latency is the difference to the time stamp taken by the kernel on entry.
+ */
+int measure_syscall_entry(struct syscall_entry_stats *stats, int samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file job_runner.h
+ * Periodic job loop with per-job timing statistics
+ *
+ * A job runner owns the usual
+ *
+ *     do { sleep_next_period(); done = job(); } while (!done);
+ *
+ * loop of a LITMUS^RT task. For each job, it obtains the release and
+ * absolute deadline from the control page (see get_job_state()) or, if the
+ * kernel does not publish them, derives them from the job number, the
+ * task's period, and the release of the job that was current when the loop
+ * started. It takes time stamps at the start and the completion of
+ * the job, and measures the CPU time consumed by the job. The results are
+ * accumulated in a struct job_stats, which other threads or processes can
+ * read while the task is running. The job path performs no I/O and no
+ * memory allocation.
+ */
+
+#ifndef JOB_RUNNER_H
+#define JOB_RUNNER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "litmus.h"
+
+struct exec_estimator;
+struct exec_budget_policy;
+struct mode_change_task;
+struct mk_firm;
+
+/**
+ * Per-task job statistics
+ *
+ * Updated by the task after each job. Use read_job_stats() to obtain a
+ * consistent snapshot from another thread or process. All times are in
+ * nanoseconds.
+ */
+struct job_stats {
+	volatile uint64_t seq;   /**< @private Odd while an update is in progress */
+	uint64_t jobs;           /**< Completed jobs */
+	uint64_t misses;         /**< Jobs that completed after their deadline */
+	uint64_t overruns;       /**< Jobs that consumed more than exec_cost */
+	uint64_t skipped;        /**< Jobs skipped due to an (m,k)-firm
+				  *   constraint; not included in jobs */
+	unsigned int last_job_no; /**< Job number of the last completed job */
+	lt_t     max_response;   /**< Longest release-to-completion time */
+	lt_t     total_response; /**< Sum of all response times */
+	int64_t  max_lateness;   /**< Maximum of completion minus deadline */
+	lt_t     max_exec;       /**< Largest CPU time consumed by a job */
+	lt_t     total_exec;     /**< Sum of the CPU time of all jobs */
+};
+
+/**
+ * Timing of a single job, as passed to the job runner's callbacks
+ */
+struct job_timing {
+	unsigned int job_no; /**< Job number as reported by get_job_no() */
+	lt_t release;        /**< Release time (monotonic_ns() time base) */
+	lt_t deadline;       /**< Absolute deadline */
+	lt_t start;          /**< Time at which the job started executing */
+	lt_t completion;     /**< Time at which the job completed */
+	lt_t exec_time;      /**< CPU time consumed by the job */
+};
+
+/**
+ * Job function
+ * @param arg User argument given to init_job_runner()
+ * @return 0 to continue with the next job, non-zero to stop the runner
+ */
+typedef int (*job_fn_t)(void *arg);
+
+/**
+ * Callback invoked after a job that missed its deadline or overran its budget
+ * @param timing Timing of the job
+ * @param arg User argument given to init_job_runner()
+ *
+ * Called from the job loop, i.e., it should neither block nor perform I/O.
+ */
+typedef void (*job_event_fn_t)(const struct job_timing *timing, void *arg);
+
+/**
+ * State of a job runner
+ *
+ * Initialise with init_job_runner(). The callbacks and the stats pointer may
+ * be changed before run_jobs() is called.
+ */
+struct job_runner {
+	job_fn_t       job;        /**< Job function */
+	void*          arg;        /**< Argument for all callbacks */
+	job_event_fn_t on_miss;    /**< Called after a deadline miss, or NULL */
+	job_event_fn_t on_overrun; /**< Called after a budget overrun, or NULL */
+	struct job_stats *stats;   /**< Where statistics are accumulated;
+				    *   initially points to local_stats */
+	struct exec_estimator *estimator; /**< Fed with the CPU time of each
+					   *   job, or NULL */
+	const struct exec_budget_policy *budget_policy; /**< If it includes
+				    *   EXEC_BUDGET_APPLY, exec_cost is adjusted
+				    *   to the estimator's recommendation after
+				    *   each job (see apply_exec_cost()) */
+	struct mode_change_task *mode_change; /**< If not NULL, pending mode
+				    *   changes are applied after each job */
+	struct mk_firm *mk_firm;   /**< If not NULL, already released jobs
+				    *   are skipped after a late job as far as
+				    *   the (m,k)-firm constraint permits */
+
+	/** Release time of the job that is current when run_jobs() is
+	 *  called, e.g., the synchronous release time plus the task's phase
+	 *  if run_jobs() is called right after wait_for_ts_release(); not
+	 *  needed if the kernel publishes release times. If 0, it is taken to
+	 *  be the time at which run_jobs() is called, which is exact if the
+	 *  task has just entered real-time mode, and moved back if a later
+	 *  job starts before its computed release. Reset to 0 when a budget
+	 *  or mode change restarts the task's release sequence. */
+	lt_t first_release;
+
+	lt_t period;            /**< @private */
+	lt_t relative_deadline; /**< @private */
+	lt_t exec_cost;         /**< Current execution-time budget */
+	unsigned int first_job_no; /**< @private */
+	int started;            /**< @private */
+	int release_estimated;  /**< @private */
+	struct job_stats local_stats; /**< @private */
+};
+
+/**
+ * Initialise a job runner for the calling thread
+ * @param runner Runner to initialise
+ * @param job Job function
+ * @param arg Argument for job and the callbacks
+ * @return 0 on success, -1 if the task parameters cannot be obtained
+ *
+ * Must be called after set_rt_task_param(); the period, relative deadline,
+ * and execution cost are taken from the calling thread's parameters.
+ */
+int init_job_runner(struct job_runner *runner, job_fn_t job, void *arg);
+
+/**
+ * Execute jobs until the job function asks to stop
+ * @param runner Runner initialised with init_job_runner()
+ * @return 0 if the job function asked to stop, -1 on error
+ *
+ * The calling thread must be a real-time task. Each iteration waits for the
+ * next job release with sleep_next_period() before invoking the job. Jobs
+ * that are skipped to honour an (m,k)-firm constraint are completed without
+ * invoking the job function by waiting with wait_for_job_release().
+ */
+int run_jobs(struct job_runner *runner);
+
+/**
+ * Map a shared region of job statistics slots
+ * @param path File backing the region (e.g., in /dev/shm), created if missing
+ * @param count Number of struct job_stats slots (e.g., one per task)
+ * @return Pointer to the first slot, or NULL on error
+ *
+ * Point a runner's stats field at a slot to make its statistics visible to
+ * other processes.
+ */
+struct job_stats* map_job_stats(const char* path, int count);
+
+/**
+ * Obtain a consistent copy of job statistics
+ * @param stats Statistics updated by some task, possibly in another process
+ * @param snapshot Where to store the copy
+ */
+void read_job_stats(const struct job_stats *stats,
+		    struct job_stats *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
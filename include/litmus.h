@@ -223,11 +223,19 @@ int litmus_unlock(int od);
 
 /***** job control *****/
 /**
- * @todo Doxygen
+ * Obtain the sequence number of the current job
+ * @param job_no Where to store the job number
+ * @return 0 on success, -1 if the caller is not a real-time task
  */
 int get_job_no(unsigned int* job_no);
 /**
- * @todo Doxygen
+ * Complete jobs until a given job has been released
+ * @param job_no Job number to wait for
+ * @return 0 on success
+ *
+ * Jobs before job_no that have been released already complete immediately,
+ * i.e., they are skipped. Returns immediately if job_no is not in the
+ * future.
  */
 int wait_for_job_release(unsigned int job_no);
 /**
@@ -239,8 +247,24 @@ int sleep_next_period(void);
 /**
  * Initialises real-time properties for the entire program
  * @return 0 on success
+ *
+ * Locks all current and future memory of the process with mlockall().
  */
 int  init_litmus(void);
+/**
+ * Flags for init_litmus_flags()
+ */
+enum litmus_init_flags {
+	/** Do not mlockall() the address space. Real-time memory must then be
+	 *  locked explicitly, e.g., by allocating it from an rt_arena. */
+	LITMUS_NO_MLOCKALL = 0x1
+};
+/**
+ * Initialises real-time properties for the entire program
+ * @param flags Bitwise OR of enum litmus_init_flags values
+ * @return 0 on success
+ */
+int  init_litmus_flags(int flags);
 /**
  * Initialises real-time properties for current thread
  * @return 0 on success
@@ -286,6 +310,49 @@ void exit_np(void);
  */
 int  requested_to_preempt(void);
 
+/**
+ * Deferred-preemption statistics of a single thread.
+ *
+ * Updated by the owning thread in exit_np() once stats collection has been
+ * enabled with enable_np_stats(). Use read_np_stats() to obtain a consistent
+ * snapshot from another thread or process.
+ */
+struct np_stats {
+	volatile uint64_t seq; /**< @private Odd while an update is in progress */
+	uint64_t sections;     /**< Completed (outermost) NP sections */
+	uint64_t max_cycles;   /**< Longest NP section in cycles */
+	uint64_t total_cycles; /**< Cumulative length of all NP sections in cycles */
+	uint64_t delayed_preemptions; /**< Exits that found a pending preemption
+				       *   and called sched_yield() */
+};
+
+/**
+ * Map a shared region of NP statistics slots
+ * @param path File backing the region (e.g., in /dev/shm), created if missing
+ * @param count Number of struct np_stats slots (e.g., one per thread)
+ * @return Pointer to the first slot, or NULL on error
+ *
+ * Other processes can map the same file to observe the counters while the
+ * task is running.
+ */
+struct np_stats* map_np_stats(const char* path, int count);
+/**
+ * Enable (or disable) NP section accounting for the current thread
+ * @param stats Slot to accumulate into, NULL to disable accounting
+ *
+ * Nested NP sections are accounted as one section. If accounting is enabled
+ * inside an NP section, that section is accounted from the time of the call.
+ * Accounting is off by default and costs only a thread-local pointer test
+ * when disabled.
+ */
+void enable_np_stats(struct np_stats *stats);
+/**
+ * Obtain a consistent copy of NP statistics
+ * @param stats Slot updated by some thread, possibly in another process
+ * @param snapshot Where to store the copy
+ */
+void read_np_stats(const struct np_stats *stats, struct np_stats *snapshot);
+
 /***** Task System support *****/
 /**
  * Wait until task master releases all real-time tasks
@@ -318,18 +385,150 @@ int read_litmus_stats(int *ready, int *total);
  */
 int lt_sleep(lt_t timeout);
 
+/**
+ * Sleep until an absolute point in time
+ * @param wake_time Wake-up time in nanoseconds on the monotonic_ns() clock
+ * @return 0 on success, -1 on error (with errno set)
+ *
+ * Unlike lt_sleep(), loops built on this function do not accumulate drift.
+ * Interrupted sleeps are restarted.
+ */
+int lt_sleep_until(lt_t wake_time);
+
+/**
+ * Drift-free periodic release cursor for best-effort loops
+ *
+ * Use with sleep_next_release() to run a loop body periodically without
+ * becoming a LITMUS^RT task, e.g., in helper threads or when falling back to
+ * best-effort execution. Since releases are absolute monotonic_ns() times,
+ * the loop can be phase-locked to LITMUS^RT job releases.
+ */
+struct periodic_timer {
+	lt_t next_release;      /**< Absolute time of the next release */
+	lt_t period;            /**< Inter-release time in nanoseconds */
+	unsigned long releases; /**< Releases waited for so far */
+	unsigned long overruns; /**< Calls made after the release had passed */
+	unsigned long missed;   /**< Releases skipped due to overruns */
+};
+
+/**
+ * Initialise a periodic timer
+ * @param t Timer to initialise
+ * @param first_release Absolute time of the first release (0 for now)
+ * @param period Period in nanoseconds, must be positive
+ * @return 0 on success, -1 if the period is zero (errno is EINVAL)
+ */
+int init_periodic_timer(struct periodic_timer *t, lt_t first_release,
+			lt_t period);
+
+/**
+ * Sleep until the next release of a periodic timer
+ * @param t Timer initialised with init_periodic_timer()
+ * @return Number of releases skipped because the caller overran, or -1 on
+ *         error
+ *
+ * If the next release already passed, the call returns immediately, counts
+ * an overrun, and skips all but the most recent release that passed.
+ */
+int sleep_next_release(struct periodic_timer *t);
+
+/**
+ * Obtain the current time of the monotonic clock
+ * @return Time in nanoseconds
+ *
+ * This is the clock that LITMUS^RT uses for job releases. It is not affected
+ * by wall-clock adjustments and is read without a system call.
+ */
+lt_t monotonic_ns(void);
+
+/**
+ * Obtain CPU time consumed so far by the calling thread
+ * @return CPU time in nanoseconds
+ */
+lt_t thread_cputime_ns(void);
+
 /**
  * Obtain CPU time consumed so far
  * @return CPU time in seconds
+ *
+ * Prefer thread_cputime_ns() in new code.
  */
 double cputime(void);
 
 /**
  * Obtain wall-clock time
  * @return Wall-clock time in seconds
+ *
+ * Prefer monotonic_ns() for measuring intervals in new code.
  */
 double wctime(void);
 
+/***** time stamps *****/
+/*
+ * asm/cycles.h provides three ways of reading the cycle counter:
+ *  - get_cycles_unordered()  cheapest, may be reordered with surrounding code
+ *  - get_cycles_ordered()    not reordered with surrounding instructions
+ *  - get_cycles_serialized() additionally waits for prior memory accesses
+ * get_cycles() keeps its historical behaviour, which differs by architecture:
+ * on x86 it executes rdtsc between two mfence instructions, which waits for
+ * prior loads and stores but does not keep rdtsc from executing before
+ * earlier instructions have completed (that takes lfence); on ARM it is
+ * get_cycles_ordered(). Use the explicit variants where ordering matters.
+ */
+
+/**
+ * @private
+ * Fixed-point cycles-to-nanoseconds conversion factors
+ */
+struct cycles_conversion {
+	uint32_t mult;  /**< ns = (cycles * mult) >> shift */
+	uint32_t shift; /**< At most 32 */
+	uint64_t hz;    /**< Frequency the factors were derived from */
+};
+
+/**
+ * @private
+ * Conversion factors used by cycles_to_ns()
+ */
+extern struct cycles_conversion cycles_conv;
+
+/**
+ * Determine the cycle counter frequency and set up cycles_to_ns()
+ * @param duration Calibration interval in nanoseconds (0 for the default of
+ *        100ms). Ignored if the architecture reports the counter frequency.
+ * @return The frequency in Hz, or 0 with errno set on failure, in which
+ *         case the conversion factors are left unchanged
+ *
+ * Sleeps for the calibration interval; call it during initialization.
+ * Results are only meaningful if cycles_invariant() holds.
+ */
+uint64_t calibrate_cycles(lt_t duration);
+
+/**
+ * Set up cycles_to_ns() for a known cycle counter frequency
+ * @param hz Counter frequency in Hz
+ */
+void set_cycles_frequency(uint64_t hz);
+
+/**
+ * Convert a cycle count to nanoseconds without division
+ * @param cycles Cycle count (typically the difference of two time stamps)
+ * @return Nanoseconds, or 0 if the counter has not been calibrated
+ */
+static inline lt_t cycles_to_ns(cycles_t cycles)
+{
+	uint64_t c = cycles;
+	uint32_t hi = c >> 32, lo = c;
+	uint64_t ns;
+
+	/* c * mult would overflow 64 bits, so multiply each half separately */
+	ns = ((uint64_t) lo * cycles_conv.mult) >> cycles_conv.shift;
+	if (hi)
+		ns += ((uint64_t) hi * cycles_conv.mult)
+			<< (32 - cycles_conv.shift);
+	return ns;
+}
+
 /***** semaphore allocation ******/
 /**
  * Allocate a semaphore following the FMLP protocol
@@ -416,6 +615,109 @@ int null_call(cycles_t *timestamp);
  */
 struct control_page* get_ctrl_page(void);
 
+/**
+ * State of the current job of a real-time task
+ */
+struct job_state {
+	unsigned int job_no; /**< Job number, as reported by get_job_no() */
+	lt_t release;        /**< Release time (monotonic_ns() time base), or 0
+			      *   if the kernel does not publish it */
+	lt_t deadline;       /**< Absolute deadline, or 0 if the kernel does
+			      *   not publish it */
+};
+
+/**
+ * Read the state of the calling task's current job
+ * @param state Where to store the job state
+ * @return 0 on success, -1 on error
+ *
+ * Kernels that publish the current job in the control page (i.e., whose
+ * struct control_page in litmus/rt_param.h has a job_index field; the
+ * Makefile then defines LITMUS_CP_JOB_STATE) are served without a system
+ * call; the reads are retried if a job boundary passes in between.
+ * With other kernels, only the job number is available, obtained with
+ * get_job_no(). Like get_job_no(), only meaningful for real-time tasks.
+ */
+int get_job_state(struct job_state *state);
+
+/**
+ * Whether get_job_state() reads the control page
+ * @return 1 if the job state is read from the control page, 0 if
+ *         get_job_state() falls back to system calls
+ */
+int job_state_in_ctrl_page(void);
+
+/***** inline system calls *****/
+
+/* Where the architecture provides raw system call stubs (see
+ * asm/raw_syscall.h), programs that define LITMUS_INLINE_SYSCALLS before
+ * including litmus.h have the wrappers that are called on every job inlined
+ * into the caller instead of going through the variadic syscall(). This
+ * turns sleep_next_period(), get_job_no(), litmus_lock(), litmus_unlock()
+ * and null_call() into function-like macros, and pulls in <errno.h> and the
+ * kernel's system call numbers; it is therefore not the default. The
+ * out-of-line versions remain available, e.g., as (sleep_next_period)(). */
+#ifdef LITMUS_INLINE_SYSCALLS
+#include "asm/raw_syscall.h"
+#endif
+
+#if defined(LITMUS_INLINE_SYSCALLS) && defined(LITMUS_RAW_SYSCALLS)
+
+#include <errno.h>
+#include "asm/unistd.h"
+
+/** @private Convert a raw system call result to the syscall() convention */
+static inline int litmus_syscall_result(long ret)
+{
+	if ((unsigned long) ret > -4096UL) {
+		errno = (int) -ret;
+		return -1;
+	}
+	return (int) ret;
+}
+
+/** @private */
+static inline int litmus_inline_sleep_next_period(void)
+{
+	return litmus_syscall_result(litmus_raw_syscall0(__NR_complete_job));
+}
+
+/** @private */
+static inline int litmus_inline_get_job_no(unsigned int *job_no)
+{
+	return litmus_syscall_result(
+		litmus_raw_syscall1(__NR_query_job_no, (long) job_no));
+}
+
+/** @private */
+static inline int litmus_inline_lock(int od)
+{
+	return litmus_syscall_result(
+		litmus_raw_syscall1(__NR_litmus_lock, od));
+}
+
+/** @private */
+static inline int litmus_inline_unlock(int od)
+{
+	return litmus_syscall_result(
+		litmus_raw_syscall1(__NR_litmus_unlock, od));
+}
+
+/** @private */
+static inline int litmus_inline_null_call(cycles_t *timestamp)
+{
+	return litmus_syscall_result(
+		litmus_raw_syscall1(__NR_null_call, (long) timestamp));
+}
+
+#define sleep_next_period()  litmus_inline_sleep_next_period()
+#define get_job_no(job_no)   litmus_inline_get_job_no(job_no)
+#define litmus_lock(od)      litmus_inline_lock(od)
+#define litmus_unlock(od)    litmus_inline_unlock(od)
+#define null_call(timestamp) litmus_inline_null_call(timestamp)
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
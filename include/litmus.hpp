@@ -0,0 +1,300 @@
+/**
+ * @file litmus.hpp
+ * Header-only C++ wrappers for tasks, locks, and non-preemptive sections
+ *
+ * The wrappers add no state or calls beyond those of the C API in litmus.h:
+ * every member function is inline and forwards to the corresponding C
+ * function, and all conversions of std::chrono durations to lt_t happen at
+ * compile time when the durations are constants.
+ *
+ * Example:
+ * @code
+ * using namespace std::chrono_literals;
+ *
+ * constexpr auto params = litmus::checked(litmus::task_params{
+ *	.exec_cost = 2ms, .period = 10ms });
+ *
+ * litmus::rt_task_scope rt(params);    // set_rt_task_param(), task_mode()
+ * litmus::resource<FMLP_SEM> sem(fd, 0);
+ * {
+ *	litmus::scoped_lock guard(sem); // litmus_lock()
+ *	litmus::np_section np;          // enter_np()
+ *	...
+ * }                                    // exit_np(), litmus_unlock()
+ * @endcode
+ *
+ * Requires a C++20 compiler (e.g., g++ -std=c++20).
+ */
+
+#ifndef LITMUS_HPP
+#define LITMUS_HPP
+
+#include <chrono>
+#include <utility>
+
+#include <unistd.h>
+
+#include "litmus.h"
+
+namespace litmus {
+
+/***** time *****/
+
+/**
+ * Convert a duration to nanoseconds in LITMUS^RT's time type
+ * @param d Duration; must not be negative
+ */
+template <typename Rep, typename Period>
+constexpr lt_t to_lt(std::chrono::duration<Rep, Period> d) noexcept
+{
+	return static_cast<lt_t>(
+		std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+}
+
+/***** task parameters *****/
+
+/**
+ * Real-time task parameters with std::chrono durations
+ *
+ * The defaults match those of init_rt_task_param(). Members are ordered so
+ * that designated initialisers can be used (see the example above).
+ */
+struct task_params {
+	std::chrono::nanoseconds exec_cost{0};         /**< Budget */
+	std::chrono::nanoseconds period{0};            /**< Period */
+	std::chrono::nanoseconds relative_deadline{0}; /**< 0: implicit */
+	std::chrono::nanoseconds phase{0};             /**< Release offset */
+	unsigned int cpu = 0;                          /**< CPU (partitioned) */
+	unsigned int priority = LITMUS_LOWEST_PRIORITY; /**< Fixed priority */
+	task_class_t cls = RT_CLASS_SOFT;              /**< Task class */
+	budget_policy_t budget_policy = NO_ENFORCEMENT; /**< Budget policy */
+	release_policy_t release_policy = TASK_SPORADIC; /**< Release policy */
+
+	/**
+	 * Whether the kernel would accept these parameters: positive budget
+	 * and period, a budget that fits into both the period and the
+	 * deadline, a valid fixed priority, and known enumerators
+	 */
+	constexpr bool valid() const noexcept
+	{
+		auto deadline = relative_deadline.count() ?
+			relative_deadline : period;
+
+		return exec_cost.count() > 0 && period.count() > 0 &&
+			phase.count() >= 0 && deadline.count() > 0 &&
+			exec_cost <= period && exec_cost <= deadline &&
+			litmus_is_valid_fixed_prio(priority) &&
+			cls >= RT_CLASS_HARD && cls <= RT_CLASS_BEST_EFFORT &&
+			budget_policy >= NO_ENFORCEMENT &&
+			budget_policy <= PRECISE_ENFORCEMENT &&
+			release_policy >= TASK_SPORADIC &&
+			release_policy <= TASK_EARLY;
+	}
+
+	/** The equivalent C parameters */
+	constexpr struct rt_task c_params() const noexcept
+	{
+		struct rt_task p{};
+
+		p.exec_cost         = to_lt(exec_cost);
+		p.period            = to_lt(period);
+		p.relative_deadline = to_lt(relative_deadline);
+		p.phase             = to_lt(phase);
+		p.cpu               = cpu;
+		p.priority          = priority;
+		p.cls               = cls;
+		p.budget_policy     = budget_policy;
+		p.release_policy    = release_policy;
+		return p;
+	}
+};
+
+namespace detail {
+/* not constexpr: calling it from checked() aborts constant evaluation */
+inline void invalid_task_params() noexcept {}
+}
+
+/**
+ * Validate task parameters at compile time
+ * @param p Parameters, a constant expression
+ * @return p; compilation fails if p is not valid()
+ */
+consteval task_params checked(task_params p)
+{
+	if (!p.valid())
+		detail::invalid_task_params();
+	return p;
+}
+
+/***** real-time task scope *****/
+
+/**
+ * Makes the calling thread a real-time task for the lifetime of the object
+ *
+ * The constructor sets the task parameters and switches to LITMUS_RT_TASK;
+ * the destructor switches back to BACKGROUND_TASK if the switch succeeded.
+ * init_litmus() must have been called before.
+ */
+class rt_task_scope {
+public:
+	/** @param params Task parameters for the calling thread */
+	explicit rt_task_scope(const task_params &params) noexcept
+		: rt_task_scope(params.c_params())
+	{
+	}
+
+	/** @param params Task parameters for the calling thread */
+	explicit rt_task_scope(struct rt_task params) noexcept
+	{
+		ok = set_rt_task_param(gettid(), &params) == 0 &&
+			task_mode(LITMUS_RT_TASK) == 0;
+	}
+
+	~rt_task_scope()
+	{
+		if (ok)
+			task_mode(BACKGROUND_TASK);
+	}
+
+	rt_task_scope(const rt_task_scope&) = delete;
+	rt_task_scope& operator=(const rt_task_scope&) = delete;
+
+	/** Whether the thread became a real-time task (errno tells why not) */
+	explicit operator bool() const noexcept { return ok; }
+
+private:
+	bool ok;
+};
+
+/***** non-preemptive sections *****/
+
+/**
+ * Non-preemptive section lasting for the lifetime of the object
+ *
+ * Sections nest, like enter_np() and exit_np().
+ */
+class np_section {
+public:
+	np_section() noexcept { enter_np(); }
+	~np_section() { exit_np(); }
+
+	np_section(const np_section&) = delete;
+	np_section& operator=(const np_section&) = delete;
+};
+
+/***** locks *****/
+
+/**
+ * A lock of a given protocol, open for the calling task
+ *
+ * The lock is closed when the object is destroyed.
+ */
+template <obj_type_t Protocol>
+class resource {
+public:
+	/**
+	 * Open a lock of a protocol without configuration (FMLP, SRP, MPCP,
+	 * MPCP-VS)
+	 * @param fd File descriptor of the shared file that names the lock
+	 * @param id Numerical ID of the lock within the file
+	 */
+	resource(int fd, int id) noexcept
+		requires (Protocol != PCP_SEM && Protocol != DPCP_SEM &&
+			  Protocol != DFLP_SEM)
+		: od(od_openx(fd, Protocol, id, nullptr))
+	{
+	}
+
+	/**
+	 * Open a lock of a protocol that is bound to a CPU (PCP, DPCP, DFLP)
+	 * @param fd File descriptor of the shared file that names the lock
+	 * @param id Numerical ID of the lock within the file
+	 * @param cpu CPU of the lock
+	 */
+	resource(int fd, int id, int cpu) noexcept
+		requires (Protocol == PCP_SEM || Protocol == DPCP_SEM ||
+			  Protocol == DFLP_SEM)
+		: od(od_openx(fd, Protocol, id, &cpu))
+	{
+	}
+
+	resource(resource &&other) noexcept : od(std::exchange(other.od, -1)) {}
+	resource& operator=(resource &&other) noexcept
+	{
+		if (this != &other) {
+			if (od >= 0)
+				od_close(od);
+			od = std::exchange(other.od, -1);
+		}
+		return *this;
+	}
+	resource(const resource&) = delete;
+	resource& operator=(const resource&) = delete;
+
+	~resource()
+	{
+		if (od >= 0)
+			od_close(od);
+	}
+
+	/** Object descriptor, or a negative value if the lock is not open */
+	int descriptor() const noexcept { return od; }
+
+	/** Whether the lock could be opened */
+	explicit operator bool() const noexcept { return od >= 0; }
+
+	/** Obtain the lock; see litmus_lock() */
+	int lock() noexcept { return litmus_lock(od); }
+
+	/** Release the lock; see litmus_unlock() */
+	int unlock() noexcept { return litmus_unlock(od); }
+
+private:
+	int od;
+};
+
+/**
+ * Holds a lock for the lifetime of the object
+ *
+ * The protocol is part of the type, so guards of different protocols cannot
+ * be confused: scoped_lock<FMLP_SEM> only accepts resource<FMLP_SEM>. With
+ * class template argument deduction, it is deduced from the resource.
+ */
+template <obj_type_t Protocol>
+class scoped_lock {
+public:
+	/** @param r Lock to obtain */
+	explicit scoped_lock(resource<Protocol> &r) noexcept
+		: od(r.descriptor())
+	{
+		ok = litmus_lock(od) == 0;
+	}
+
+	~scoped_lock()
+	{
+		if (ok)
+			litmus_unlock(od);
+	}
+
+	scoped_lock(const scoped_lock&) = delete;
+	scoped_lock& operator=(const scoped_lock&) = delete;
+
+	/** Whether the lock was obtained (errno tells why not) */
+	explicit operator bool() const noexcept { return ok; }
+
+private:
+	int od;
+	bool ok;
+};
+
+using fmlp_lock = scoped_lock<FMLP_SEM>;       /**< FMLP guard */
+using srp_lock  = scoped_lock<SRP_SEM>;        /**< SRP guard */
+using mpcp_lock = scoped_lock<MPCP_SEM>;       /**< MPCP guard */
+using mpcp_vs_lock = scoped_lock<MPCP_VS_SEM>; /**< MPCP-VS guard */
+using dpcp_lock = scoped_lock<DPCP_SEM>;       /**< DPCP guard */
+using pcp_lock  = scoped_lock<PCP_SEM>;        /**< PCP guard */
+using dflp_lock = scoped_lock<DFLP_SEM>;       /**< DFLP guard */
+
+} // namespace litmus
+
+#endif
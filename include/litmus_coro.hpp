@@ -0,0 +1,469 @@
+/**
+ * @file litmus_coro.hpp
+ * C++20 coroutines that multiplex periodic activities onto one RT thread
+ *
+ * Many small periodic activities with (ideally harmonic) periods can share
+ * a single LITMUS^RT task whose period is the greatest common divisor of
+ * theirs. Each activity is a coroutine that co_awaits next_period() at the
+ * end of each of its jobs. The multiplexer resumes every activity whose
+ * release falls into the current job of the thread, in the order in which
+ * the activities were spawned. Activities may also co_await a cooperative
+ * mutex or a preemption_point().
+ *
+ * Coroutine frames are allocated from a locked rt_pool (see arena.h), so
+ * spawning an activity does not call malloc(); if the pool is exhausted or a
+ * frame is larger than the pool's objects, spawn() fails.
+ *
+ * Example:
+ * @code
+ * litmus::coro::activity blink(int led)
+ * {
+ *	for (;;) {
+ *		toggle(led);
+ *		co_await litmus::coro::next_period();
+ *	}
+ * }
+ *
+ * litmus::coro::multiplexer<8> mux(512, 8);
+ * mux.spawn(ms2ns(10), [] { return blink(1); });
+ * mux.spawn(ms2ns(20), [] { return blink(2); });
+ * // make the thread a real-time task with period mux.base_period()
+ * mux.run();
+ * @endcode
+ *
+ * Requires a C++20 compiler (e.g., g++ -std=c++20).
+ */
+
+#ifndef LITMUS_CORO_HPP
+#define LITMUS_CORO_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+#include "litmus.h"
+#include "arena.h"
+
+namespace litmus {
+namespace coro {
+
+/**
+ * Timing statistics of one activity; times in nanoseconds
+ */
+struct activity_stats {
+	uint64_t jobs;         /**< Completed jobs */
+	uint64_t misses;       /**< Jobs completed after release + period */
+	lt_t     max_exec;     /**< Longest time the activity ran in one job */
+	lt_t     total_exec;   /**< Sum of all execution times */
+	lt_t     max_response; /**< Longest release-to-completion time */
+};
+
+class activity;
+
+namespace detail {
+
+/* frame pool of the multiplexer that is currently spawning */
+inline thread_local rt_pool *spawning_pool = nullptr;
+
+/* the pool pointer precedes each frame; keeps frames RT_ARENA_ALIGN-aligned */
+constexpr std::size_t frame_header = RT_ARENA_ALIGN;
+
+enum class state { sleeping, ready, yielded, blocked, done };
+
+} // namespace detail
+
+/**
+ * Return type of activity coroutines
+ */
+class activity {
+public:
+	struct promise_type {
+		detail::state state = detail::state::sleeping;
+		promise_type *next_waiter = nullptr;
+
+		static void* operator new(std::size_t size) noexcept
+		{
+			rt_pool *pool = detail::spawning_pool;
+			char *mem;
+
+			if (!pool || size + detail::frame_header > pool->obj_size)
+				return nullptr;
+			mem = static_cast<char*>(rt_pool_alloc(pool));
+			if (!mem)
+				return nullptr;
+			*reinterpret_cast<rt_pool**>(mem) = pool;
+			return mem + detail::frame_header;
+		}
+
+		static void operator delete(void *frame) noexcept
+		{
+			char *mem = static_cast<char*>(frame) - detail::frame_header;
+			rt_pool_free(*reinterpret_cast<rt_pool**>(mem), mem);
+		}
+
+		static activity get_return_object_on_allocation_failure() noexcept
+		{
+			return activity();
+		}
+
+		activity get_return_object() noexcept
+		{
+			return activity(handle::from_promise(*this));
+		}
+
+		std::suspend_always initial_suspend() noexcept { return {}; }
+		std::suspend_always final_suspend() noexcept { return {}; }
+		void return_void() noexcept {}
+		void unhandled_exception() noexcept { std::terminate(); }
+	};
+
+	using handle = std::coroutine_handle<promise_type>;
+
+	activity() noexcept : h() {}
+	activity(activity &&other) noexcept : h(std::exchange(other.h, {})) {}
+	activity& operator=(activity &&other) noexcept
+	{
+		if (this != &other) {
+			if (h)
+				h.destroy();
+			h = std::exchange(other.h, {});
+		}
+		return *this;
+	}
+	activity(const activity&) = delete;
+	activity& operator=(const activity&) = delete;
+	~activity()
+	{
+		if (h)
+			h.destroy();
+	}
+
+	/** Whether the coroutine frame could be allocated */
+	explicit operator bool() const noexcept { return static_cast<bool>(h); }
+
+private:
+	explicit activity(handle h) noexcept : h(h) {}
+
+	handle h;
+
+	template <std::size_t> friend class multiplexer;
+};
+
+/** Awaitable that ends the current job of an activity */
+struct next_period_awaiter {
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(activity::handle h) const noexcept
+	{
+		h.promise().state = detail::state::sleeping;
+	}
+	void await_resume() const noexcept {}
+};
+
+/**
+ * End the current job; the activity resumes at its next release
+ */
+inline next_period_awaiter next_period() noexcept { return {}; }
+
+/** Awaitable that lets other ready activities run first */
+struct preemption_point_awaiter {
+	bool await_ready() const noexcept { return false; }
+	void await_suspend(activity::handle h) const noexcept
+	{
+		h.promise().state = detail::state::yielded;
+	}
+	void await_resume() const noexcept {}
+};
+
+/**
+ * Let all other activities that are ready in the current job of the thread
+ * run before continuing
+ */
+inline preemption_point_awaiter preemption_point() noexcept { return {}; }
+
+/**
+ * Mutual exclusion among the activities of one multiplexer
+ *
+ * Activities only interleave at co_await points, so a mutex is needed only
+ * for critical sections that span them. Waiters are served in FIFO order;
+ * the queue is intrusive and does not allocate. For locks shared with other
+ * threads, use the LITMUS^RT locking protocols (litmus_lock()) instead,
+ * which block the whole thread.
+ */
+class mutex {
+public:
+	struct lock_awaiter {
+		mutex &m;
+
+		bool await_ready() noexcept
+		{
+			if (m.locked)
+				return false;
+			m.locked = true;
+			return true;
+		}
+		void await_suspend(activity::handle h) noexcept
+		{
+			activity::promise_type &p = h.promise();
+
+			p.state = detail::state::blocked;
+			p.next_waiter = nullptr;
+			if (m.tail)
+				m.tail->next_waiter = &p;
+			else
+				m.head = &p;
+			m.tail = &p;
+		}
+		void await_resume() const noexcept {}
+	};
+
+	/** Acquire the mutex; use as co_await m.lock() */
+	lock_awaiter lock() noexcept { return lock_awaiter{*this}; }
+
+	/** Release the mutex, handing it over to the longest waiter */
+	void unlock() noexcept
+	{
+		activity::promise_type *next = head;
+
+		if (!next) {
+			locked = false;
+			return;
+		}
+		head = next->next_waiter;
+		if (!head)
+			tail = nullptr;
+		next->state = detail::state::ready;
+	}
+
+private:
+	bool locked = false;
+	activity::promise_type *head = nullptr;
+	activity::promise_type *tail = nullptr;
+};
+
+/**
+ * Runs up to MaxActivities activities in the calling real-time thread
+ */
+template <std::size_t MaxActivities>
+class multiplexer {
+public:
+	/**
+	 * @param frame_size Largest coroutine frame to support, in bytes
+	 * @param max_frames Number of frames in the pool
+	 */
+	multiplexer(std::size_t frame_size, std::size_t max_frames) noexcept
+		: n(0), base(0), stopped(false)
+	{
+		pool_ok = rt_pool_init(&pool, frame_size + detail::frame_header,
+				       max_frames) == 0;
+	}
+
+	~multiplexer()
+	{
+		for (std::size_t i = 0; i < n; i++)
+			slots[i].act = activity();
+		if (pool_ok)
+			rt_pool_destroy(&pool);
+	}
+
+	multiplexer(const multiplexer&) = delete;
+	multiplexer& operator=(const multiplexer&) = delete;
+
+	/**
+	 * Add an activity
+	 * @param period Period of the activity in nanoseconds
+	 * @param make Callable that returns the activity's coroutine
+	 * @return Index of the activity, or -1 if no frame or slot is left
+	 *
+	 * The coroutine is created inside spawn() so that its frame is taken
+	 * from this multiplexer's pool. Its first job is released with the
+	 * first job of the thread.
+	 */
+	template <typename F>
+	int spawn(lt_t period, F &&make)
+	{
+		activity act;
+
+		if (!pool_ok || !period || n == MaxActivities)
+			return -1;
+		detail::spawning_pool = &pool;
+		act = make();
+		detail::spawning_pool = nullptr;
+		if (!act)
+			return -1;
+
+		slots[n] = slot();
+		slots[n].act = std::move(act);
+		slots[n].period = period;
+		base = base ? gcd(base, period) : period;
+		return static_cast<int>(n++);
+	}
+
+	/**
+	 * Period that the calling thread must use as a LITMUS^RT task: the
+	 * greatest common divisor of all activity periods
+	 */
+	lt_t base_period() const noexcept { return base; }
+
+	/**
+	 * Execute jobs until all activities have finished or stop() was called
+	 * @return 0 on success, -1 if the calling thread is not a real-time
+	 *         task with period base_period()
+	 */
+	int run() noexcept
+	{
+		rt_task params;
+		unsigned int job_no, first_job_no = 0;
+		lt_t first_release = 0, now;
+		bool started = false;
+
+		if (get_rt_task_param(gettid(), &params) != 0 ||
+		    params.period != base)
+			return -1;
+
+		while (!stopped && live()) {
+			if (sleep_next_period() != 0 || get_job_no(&job_no) != 0)
+				return -1;
+			now = monotonic_ns();
+			if (!started) {
+				started = true;
+				first_job_no = job_no;
+				first_release = now;
+			}
+			run_tick(job_no - first_job_no, first_release +
+				 (job_no - first_job_no) * base);
+		}
+		return 0;
+	}
+
+	/**
+	 * Execute one job of the thread
+	 * @param tick Number of base periods since the first job
+	 * @param release Release time of this job of the thread
+	 *
+	 * run() calls this once per job; it is public for custom job loops.
+	 */
+	void run_tick(uint64_t tick, lt_t release) noexcept
+	{
+		bool progress;
+		std::size_t i;
+
+		for (i = 0; i < n; i++) {
+			slot &s = slots[i];
+			if (state(s) == detail::state::sleeping &&
+			    s.next_tick <= tick) {
+				/* may be late if the previous job overran */
+				s.release = release -
+					(tick - s.next_tick) * base;
+				s.exec = 0;
+				set_state(s, detail::state::ready);
+			}
+		}
+
+		do {
+			progress = false;
+			for (i = 0; i < n; i++) {
+				if (state(slots[i]) == detail::state::ready ||
+				    state(slots[i]) == detail::state::yielded) {
+					resume(slots[i]);
+					progress = true;
+				}
+			}
+		} while (progress);
+	}
+
+	/** Stop run() after the current job of the thread */
+	void stop() noexcept { stopped = true; }
+
+	/** Timing statistics of an activity */
+	const activity_stats& stats(int index) const noexcept
+	{
+		return slots[index].stats;
+	}
+
+	/** Number of activities */
+	std::size_t size() const noexcept { return n; }
+
+	/** Whether the frame pool could be set up */
+	explicit operator bool() const noexcept { return pool_ok; }
+
+private:
+	struct slot {
+		activity act;
+		lt_t period = 0;
+		uint64_t next_tick = 0;
+		lt_t release = 0;
+		lt_t exec = 0;
+		activity_stats stats = {};
+	};
+
+	static lt_t gcd(lt_t a, lt_t b) noexcept
+	{
+		while (b) {
+			lt_t t = a % b;
+			a = b;
+			b = t;
+		}
+		return a;
+	}
+
+	static detail::state state(const slot &s) noexcept
+	{
+		return s.act.h.promise().state;
+	}
+
+	static void set_state(slot &s, detail::state st) noexcept
+	{
+		s.act.h.promise().state = st;
+	}
+
+	bool live() const noexcept
+	{
+		for (std::size_t i = 0; i < n; i++)
+			if (state(slots[i]) != detail::state::done)
+				return true;
+		return false;
+	}
+
+	void resume(slot &s) noexcept
+	{
+		lt_t start = monotonic_ns(), end, response;
+
+		set_state(s, detail::state::ready);
+		s.act.h.resume();
+		end = monotonic_ns();
+		s.exec += end - start;
+
+		if (s.act.h.done()) {
+			set_state(s, detail::state::done);
+			return;
+		}
+		if (state(s) != detail::state::sleeping)
+			return;
+
+		/* the activity completed a job */
+		response = end - s.release;
+		s.stats.jobs++;
+		s.stats.total_exec += s.exec;
+		if (s.exec > s.stats.max_exec)
+			s.stats.max_exec = s.exec;
+		if (response > s.stats.max_response)
+			s.stats.max_response = response;
+		if (response > s.period)
+			s.stats.misses++;
+		s.next_tick += s.period / base;
+	}
+
+	rt_pool pool;
+	bool pool_ok;
+	slot slots[MaxActivities];
+	std::size_t n;
+	lt_t base;
+	bool stopped;
+};
+
+} // namespace coro
+} // namespace litmus
+
+#endif
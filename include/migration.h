@@ -71,3 +71,57 @@ int domain_to_cpus(int domain, unsigned long long int* mask);
 int cpu_to_domains(int cpu, unsigned long long int* mask);
 
 int domain_to_first_cpu(int domain);
+
+/***** housekeeping threads *****/
+
+/**
+ * Determine the CPUs that are left for housekeeping
+ * @param rt_domains Domains (partitions or clusters) used by real-time tasks
+ * @param ndomains Number of domains
+ * @param mask Where to store the bit mask of all online CPUs outside of
+ *        these domains
+ * @return 0 on success, -1 if a domain is unknown or no CPU is left
+ */
+int housekeeping_cpus(const int *rt_domains, int ndomains,
+		      unsigned long long int* mask);
+
+/**
+ * Move the non-real-time threads of the calling process to a set of CPUs
+ * @param mask Bit mask of housekeeping CPUs, e.g., from housekeeping_cpus()
+ * @return Number of threads moved, or -1 on error
+ *
+ * Enumerates /proc/self/task. A thread is considered real-time, and left
+ * alone, if it is in real-time mode, if it has been given real-time
+ * parameters with set_rt_task_param(), or if its affinity lies entirely
+ * outside mask, e.g., because it has been migrated to its domain with
+ * be_migrate_to_domain() and is about to be given real-time parameters.
+ * All others, including the caller, are moved with sched_setaffinity().
+ * Threads that exit concurrently are ignored.
+ *
+ * A thread that calls be_migrate_to_domain() between the check of its
+ * affinity and its move is still moved to mask, and its admission to a
+ * partitioned plugin then fails. To rule this out, admit the real-time
+ * threads before starting a housekeeping watcher.
+ */
+int migrate_housekeeping_threads(unsigned long long int mask);
+
+/**
+ * Keep moving new non-real-time threads to a set of CPUs
+ * @param mask Bit mask of housekeeping CPUs, e.g., from housekeeping_cpus()
+ * @param interval_ns How often to look for new threads, in nanoseconds
+ * @return 0 on success, -1 on error or if a watcher is already running
+ *
+ * Calls migrate_housekeeping_threads() once and then starts a watcher
+ * thread (itself a housekeeping thread) that repeats it every interval_ns,
+ * so that threads created later, e.g., by other libraries, are moved as
+ * well. There is at most one watcher per process.
+ */
+int start_housekeeping_watcher(unsigned long long int mask,
+			       unsigned long long interval_ns);
+
+/**
+ * Stop the watcher started with start_housekeeping_watcher()
+ *
+ * Waits for the watcher thread to exit. Threads keep their affinity.
+ */
+void stop_housekeeping_watcher(void);
@@ -0,0 +1,83 @@
+/**
+ * @file mk_firm.h
+ * (m,k)-firm overload handling by skipping jobs
+ *
+ * A task with an (m,k)-firm constraint must complete at least m jobs by
+ * their deadlines in any window of k consecutive jobs. When an overrun makes
+ * a job finish late, the following jobs are often already released and would
+ * be late as well. Instead of working through the backlog, such a task can
+ * skip some of these jobs, as long as the constraint permits, and resume with
+ * a job that still has a chance to meet its deadline.
+ */
+
+#ifndef MK_FIRM_H
+#define MK_FIRM_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "litmus.h"
+
+/**
+ * Maximum window size k
+ */
+#define MK_FIRM_MAX_K 64
+
+/**
+ * State of an (m,k)-firm constraint
+ */
+struct mk_firm {
+	unsigned int m;     /**< Jobs per window that must meet their deadline */
+	unsigned int k;     /**< Window size in jobs */
+	lt_t threshold;     /**< Skip only after jobs later than this */
+	uint64_t history;   /**< Outcome of the last k jobs, most recent in
+			     *   bit 0; a set bit means the deadline was met */
+	uint64_t skipped;   /**< Jobs skipped so far */
+	uint64_t violations; /**< Jobs after which the window held fewer than
+			      *   m met deadlines */
+};
+
+/**
+ * Initialise an (m,k)-firm constraint
+ * @param mk Constraint to initialise
+ * @param m Jobs per window that must meet their deadline
+ * @param k Window size, at most MK_FIRM_MAX_K
+ * @param threshold Lateness (completion minus deadline) in nanoseconds that
+ *        a job must exceed before any job is skipped
+ * @return 0 on success, -1 if m and k are not 0 < m <= k <= MK_FIRM_MAX_K
+ *
+ * The history starts out as if all previous jobs had met their deadlines.
+ */
+int init_mk_firm(struct mk_firm *mk, unsigned int m, unsigned int k,
+		 lt_t threshold);
+
+/**
+ * Record the outcome of a job
+ * @param mk Constraint
+ * @param met Whether the job met its deadline
+ */
+void mk_firm_record(struct mk_firm *mk, int met);
+
+/**
+ * Determine how many upcoming jobs may be skipped
+ * @param mk Constraint
+ * @param backlog Number of jobs that are already due
+ * @return The largest number of jobs, at most backlog, that can be skipped
+ *         without violating the constraint
+ */
+unsigned int mk_firm_skippable(const struct mk_firm *mk,
+			       unsigned int backlog);
+
+/**
+ * Record that jobs are skipped
+ * @param mk Constraint
+ * @param count Number of skipped jobs; each counts as a missed deadline
+ */
+void mk_firm_skip(struct mk_firm *mk, unsigned int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file mode_change.h
+ * Coordinated parameter changes for groups of real-time tasks
+ *
+ * A coordinator and the tasks of a task set share a region with one slot per
+ * task. To switch the task set to a new operating mode, the coordinator
+ * writes the new parameters (and, optionally, a new domain) of each affected
+ * task into its slot and commits them by incrementing the region's
+ * generation counter. Each task checks the counter at its next job boundary
+ * with mode_change_poll() (job runners do so automatically), applies its new
+ * parameters, and acknowledges the generation. The coordinator learns from
+ * the acknowledgements when the transition is complete.
+ *
+ * LITMUS^RT does not allow changing the parameters of a task in real-time
+ * mode, so a task applies a change by briefly returning to background mode.
+ * Its release sequence restarts when it re-enters real-time mode.
+ */
+
+#ifndef MODE_CHANGE_H
+#define MODE_CHANGE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "litmus.h"
+
+/**
+ * Parameters of one task in a mode change region
+ */
+struct mode_change_slot {
+	struct rt_task params;  /**< Parameters for the committed generation */
+	int domain;             /**< Domain to migrate to, or -1 to stay */
+	volatile uint32_t assigned; /**< Generation that the parameters were
+				 *   assigned for, 0 if never */
+	volatile uint32_t acked; /**< Last generation applied by the task */
+	volatile int error;     /**< errno of the last failed application, 0
+				 *   if it succeeded */
+	volatile uint64_t seq;  /**< @private Odd while the coordinator
+				 *   updates params, domain, and assigned */
+};
+
+/**
+ * Shared mode change region
+ */
+struct mode_change_region {
+	volatile uint32_t generation; /**< Last committed generation */
+	uint32_t ntasks;              /**< Number of slots */
+	struct mode_change_slot slots[]; /**< One slot per task */
+};
+
+/**
+ * Task-side view of a mode change region
+ */
+struct mode_change_task {
+	struct mode_change_region *region; /**< Shared region */
+	int slot;                          /**< Index of the task's slot */
+	uint32_t seen;                     /**< Last generation handled */
+};
+
+/**
+ * Map a shared mode change region
+ * @param path File backing the region (e.g., in /dev/shm), created if missing
+ * @param ntasks Number of task slots
+ * @return Pointer to the region, or NULL on error
+ *
+ * The coordinator and all tasks map the same file with the same ntasks.
+ */
+struct mode_change_region* map_mode_change(const char *path, int ntasks);
+
+/**
+ * Assign new parameters to a task (coordinator side)
+ * @param region Shared region
+ * @param slot Index of the task's slot
+ * @param params Parameters the task should use in the next generation
+ * @param domain Domain the task should migrate to, or -1 to stay
+ * @return 0 on success, -1 if slot is out of range
+ *
+ * Takes effect with the next mode_change_commit(). Slots that are not
+ * assigned anew keep their parameters, so their tasks merely acknowledge the
+ * new generation without interrupting their release sequence. A slot may be
+ * reassigned before its task has applied the previous generation: the task
+ * never sees a partially written slot, but skips to the newest parameters
+ * once they are committed.
+ */
+int mode_change_set(struct mode_change_region *region, int slot,
+		    const struct rt_task *params, int domain);
+
+/**
+ * Start a transition to the assigned parameters (coordinator side)
+ * @param region Shared region
+ * @return The new generation
+ */
+uint32_t mode_change_commit(struct mode_change_region *region);
+
+/**
+ * Count the tasks that have not yet applied a generation (coordinator side)
+ * @param region Shared region
+ * @param generation Generation returned by mode_change_commit()
+ * @return Number of assigned slots that have not acknowledged generation
+ */
+int mode_change_pending(const struct mode_change_region *region,
+			uint32_t generation);
+
+/**
+ * Wait until all tasks have applied a generation (coordinator side)
+ * @param region Shared region
+ * @param generation Generation returned by mode_change_commit()
+ * @param timeout Maximum time to wait in nanoseconds, 0 for no limit
+ * @return 0 once the transition is complete; -1 with errno set to ETIMEDOUT
+ *         if it did not complete in time, or to EIO if some task failed to
+ *         apply its parameters (see the slots' error fields)
+ */
+int mode_change_wait(const struct mode_change_region *region,
+		     uint32_t generation, lt_t timeout);
+
+/**
+ * Attach the calling task to its slot (task side)
+ * @param task Task-side state to initialise
+ * @param region Shared region
+ * @param slot Index of the task's slot
+ * @return 0 on success, -1 if slot is out of range
+ *
+ * Generations committed before attaching are acknowledged, but not applied;
+ * the task is expected to have been set up with its current parameters.
+ */
+int mode_change_attach(struct mode_change_task *task,
+		       struct mode_change_region *region, int slot);
+
+/**
+ * Apply pending parameter changes (task side)
+ * @param task State initialised with mode_change_attach()
+ * @param params If not NULL and a change was applied, receives the new
+ *        parameters
+ * @return 1 if new parameters were applied, 0 if there was nothing to do,
+ *         -1 if applying them failed
+ *
+ * Call this between jobs. Without a pending change, it costs one read of
+ * the shared generation counter. If the coordinator is updating the task's
+ * slot at the same time, or has already assigned parameters for a
+ * generation that it has not committed yet, the task does not wait: it
+ * leaves the generation unacknowledged and retries at its next call.
+ */
+int mode_change_poll(struct mode_change_task *task, struct rt_task *params);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
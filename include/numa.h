@@ -0,0 +1,142 @@
+/**
+ * @file numa.h
+ * NUMA-aware memory placement for tasks migrated to a domain
+ *
+ * be_migrate_to_domain() changes where a task runs, but its pages stay on
+ * the node on which they were first touched. On multi-socket machines, a
+ * partitioned task may thus access all of its memory remotely. The functions
+ * in this module find the NUMA node of a domain and bind or move memory to
+ * it with the mbind(), set_mempolicy(), move_pages(), and migrate_pages()
+ * system calls. They do not depend on libnuma.
+ *
+ * Like the rest of liblitmus, node sets are bit masks of at most 64 nodes.
+ */
+
+#ifndef NUMA_H
+#define NUMA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h> /* for size_t */
+
+#define NUMA_MAX_NODES 64 /**< Nodes supported */
+
+struct rt_arena;
+
+/**
+ * @name Placement flags
+ * @{
+ */
+/** Allocate only from the target node (the default) */
+#define NUMA_MEM_BIND    0x0
+/** Prefer the target node, but fall back to others if it is full */
+#define NUMA_MEM_PREFER  0x1
+/** Also move pages that are already on other nodes */
+#define NUMA_MEM_MIGRATE 0x2
+/** @} */
+
+/**
+ * Where the pages of a memory range reside relative to a node
+ */
+struct numa_page_stats {
+	long pages;  /**< Pages considered */
+	long local;  /**< Pages on the node */
+	long remote; /**< Pages on other nodes */
+	long absent; /**< Pages not backed by memory (never touched) */
+};
+
+/**
+ * Find the NUMA node that contains a set of CPUs
+ * @param sys_root Root of sysfs, NULL for /sys
+ * @param cpus Bit mask of CPUs
+ * @return ID of the node that contains all of them, or -1 if they span
+ *         several nodes or the node information is missing
+ */
+int cpus_to_node(const char *sys_root, unsigned long long cpus);
+
+/**
+ * Find the NUMA node of a domain (partition or cluster)
+ * @param domain Domain ID
+ * @return ID of the node that contains all CPUs of the domain, or -1
+ */
+int domain_to_node(int domain);
+
+/**
+ * Count the local and remote pages of a memory range
+ * @param addr Start of the range
+ * @param len Length of the range in bytes
+ * @param node Node considered local
+ * @param stats Where to store the counts
+ * @return 0 on success, -1 on error
+ *
+ * Queries every page with move_pages() without moving it.
+ */
+int count_node_pages(void *addr, size_t len, int node,
+		     struct numa_page_stats *stats);
+
+/**
+ * Count the local and remote pages of the calling process
+ * @param numa_maps File to read, NULL for /proc/self/numa_maps
+ * @param node Node considered local
+ * @param stats Where to store the counts; absent is always 0
+ * @return 0 on success, -1 on error
+ */
+int count_process_pages(const char *numa_maps, int node,
+			struct numa_page_stats *stats);
+
+/**
+ * Bind a memory range to a node
+ * @param addr Start of the range (rounded down to a page boundary)
+ * @param len Length of the range in bytes
+ * @param node Target node
+ * @param flags Placement flags
+ * @return 0 on success, -1 on error
+ *
+ * Future page faults in the range are served from the node. With
+ * NUMA_MEM_MIGRATE, pages that are already present elsewhere, including
+ * locked ones, are moved as well.
+ */
+int bind_memory_to_node(void *addr, size_t len, int node, int flags);
+
+/**
+ * Bind the memory of an arena to a node
+ * @param arena Arena initialised with rt_arena_init()
+ * @param node Target node
+ * @param flags Placement flags; arenas are prefaulted, so NUMA_MEM_MIGRATE
+ *        is needed to move their pages
+ * @return 0 on success, -1 on error
+ *
+ * For pools, pass the pool's arena.
+ */
+int rt_arena_to_node(struct rt_arena *arena, int node, int flags);
+
+/**
+ * Place the memory of the calling thread on a node
+ * @param node Target node
+ * @param flags Placement flags
+ * @return 0 on success, -1 on error
+ *
+ * Sets the memory policy of the calling thread, which applies to its future
+ * allocations (including the pages that init_litmus() locks). With
+ * NUMA_MEM_MIGRATE, all pages of the process on other nodes are moved to
+ * the node, which also affects the memory of other threads; pages that
+ * cannot be moved (e.g., shared with other processes) stay where they are.
+ */
+int migrate_memory_to_node(int node, int flags);
+
+/**
+ * Migrate the calling thread to a domain and its memory to the domain's node
+ * @param domain Domain ID
+ * @param flags Placement flags
+ * @return ID of the node on success, -1 on error (errno is EXDEV if the
+ *         domain spans several nodes; the thread is migrated nonetheless)
+ */
+int be_migrate_to_domain_numa(int domain, int flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+/**
+ * @file rt_graph.h
+ * Processing graphs of real-time tasks with end-to-end latency tracking
+ *
+ * A processing graph is a DAG whose nodes are LITMUS^RT threads and whose
+ * edges are wait-free single-producer/single-consumer queues in shared
+ * memory. Source nodes (without inputs) run periodically. All other nodes
+ * are sporadic: a node's job is released once each of its input edges holds
+ * a token, and consumes one token from every input.
+ *
+ * Every token remembers when its oldest ancestor was produced by a source
+ * and which nodes it passed on the way (its path). When two tokens are
+ * merged, the path of the older one is kept, as it determines the end-to-end
+ * latency. Sinks (without outputs) record the end-to-end latency per path,
+ * and each edge records how long tokens waited in its queue, in lock-free
+ * log2 histograms. rt_graph_report() summarises them, including the
+ * critical path, i.e., the path with the largest worst-case latency.
+ *
+ * Like rt_thread.h, this header is not included by litmus.h.
+ */
+
+#ifndef RT_GRAPH_H
+#define RT_GRAPH_H
+
+#include <stdio.h>
+
+#include "rt_thread.h"
+
+#define RT_GRAPH_MAX_NODES 32 /**< Maximum number of nodes of a graph */
+#define RT_GRAPH_MAX_EDGES 64 /**< Maximum number of edges of a graph */
+#define RT_GRAPH_MAX_PATHS 32 /**< Maximum number of tracked paths */
+#define RT_HIST_BUCKETS    64 /**< Buckets of a latency histogram */
+
+/**
+ * Lock-free histogram of latencies
+ *
+ * Bucket i counts values v with 2^(i-1) <= v < 2^i nanoseconds (bucket 0
+ * counts zeros). Any thread may add values concurrently.
+ */
+struct rt_hist {
+	uint64_t count;  /**< Number of values */
+	uint64_t sum;    /**< Sum of all values */
+	uint64_t max;    /**< Largest value */
+	uint64_t buckets[RT_HIST_BUCKETS]; /**< Value counts per bucket */
+};
+
+/**
+ * Add a value to a histogram
+ * @param h Histogram
+ * @param value Value in nanoseconds
+ */
+void rt_hist_add(struct rt_hist *h, lt_t value);
+
+/**
+ * Estimate a quantile from a histogram
+ * @param h Histogram
+ * @param q Quantile in [0, 1]
+ * @return Upper bound of the bucket that contains the quantile (at most
+ *         the maximum), 0 if the histogram is empty
+ */
+lt_t rt_hist_quantile(const struct rt_hist *h, double q);
+
+/**
+ * Data passed along the edges of a graph
+ */
+struct rt_graph_token {
+	uint64_t value;   /**< User data */
+	lt_t     origin;  /**< Time at which the oldest ancestor was produced */
+	lt_t     enqueued; /**< Time at which the token entered its edge */
+	uint64_t path;    /**< Nodes that the oldest ancestor passed, as a bit
+			   *   mask of node IDs */
+};
+
+/**
+ * Node function
+ * @param node ID of the node
+ * @param in Values of the tokens consumed from the input edges, in the
+ *        order in which the edges were added; NULL for sources
+ * @param nin Number of input edges
+ * @param out Value to send along all output edges
+ * @param arg User argument given to rt_graph_add_node()
+ * @return 0 to continue, non-zero to stop the whole graph
+ */
+typedef int (*rt_graph_fn_t)(int node, const uint64_t *in, int nin,
+			     uint64_t *out, void *arg);
+
+/**
+ * Edge between two nodes
+ */
+struct rt_graph_edge {
+	int from;               /**< Producing node */
+	int to;                 /**< Consuming node */
+	unsigned int capacity;  /**< Queue capacity (a power of two) */
+	struct rt_hist delay;   /**< Time that tokens spent in the queue */
+	uint64_t overflows;     /**< Tokens dropped because the queue was full */
+
+	struct rt_graph_token *ring; /**< @private */
+	volatile unsigned int head __attribute__((aligned(64))); /**< @private
+				 *   Next slot to consume */
+	volatile unsigned int tail __attribute__((aligned(64))); /**< @private
+				 *   Next slot to fill */
+};
+
+/**
+ * Latency statistics of one path from a source to a sink
+ */
+struct rt_graph_path {
+	volatile uint64_t nodes; /**< Bit mask of node IDs, 0 if unused */
+	struct rt_hist latency;  /**< End-to-end latencies */
+};
+
+/**
+ * Node of a graph
+ */
+struct rt_graph_node {
+	const char* name;       /**< Name used in reports */
+	struct rt_task params;  /**< Task parameters */
+	int domain;             /**< Domain to run in, or -1 */
+	rt_graph_fn_t fn;       /**< Node function */
+	void* arg;              /**< Argument for fn */
+	uint64_t jobs;          /**< Jobs executed */
+
+	int nin;                /**< @private Number of input edges */
+	int in[RT_GRAPH_MAX_EDGES];  /**< @private Input edge IDs */
+	int nout;               /**< @private Number of output edges */
+	int out[RT_GRAPH_MAX_EDGES]; /**< @private Output edge IDs */
+	volatile int wake __attribute__((aligned(64))); /**< @private Futex */
+};
+
+/**
+ * A processing graph
+ */
+struct rt_graph {
+	int nnodes;                        /**< Number of nodes */
+	int nedges;                        /**< Number of edges */
+	struct rt_graph_node nodes[RT_GRAPH_MAX_NODES]; /**< Nodes */
+	struct rt_graph_edge edges[RT_GRAPH_MAX_EDGES]; /**< Edges */
+	struct rt_graph_path paths[RT_GRAPH_MAX_PATHS]; /**< Paths seen by
+							 *   sinks */
+	uint64_t untracked;                /**< Sink tokens whose path did not
+					    *   fit into paths */
+	volatile int stop;                 /**< @private */
+	pthread_t threads[RT_GRAPH_MAX_NODES]; /**< @private */
+	struct rt_graph_thread *ctx;       /**< @private */
+};
+
+/**
+ * Initialise an empty graph
+ * @param g Graph to initialise
+ */
+void rt_graph_init(struct rt_graph *g);
+
+/**
+ * Add a node to a graph
+ * @param g Graph
+ * @param name Name used in reports
+ * @param params Task parameters; sources should be periodic, all other
+ *        nodes sporadic with a period no larger than that of their inputs
+ * @param domain Domain to run the node in, or -1
+ * @param fn Node function
+ * @param arg Argument for fn
+ * @return ID of the node, or -1 if the graph is full
+ */
+int rt_graph_add_node(struct rt_graph *g, const char *name,
+		      const struct rt_task *params, int domain,
+		      rt_graph_fn_t fn, void *arg);
+
+/**
+ * Connect two nodes
+ * @param g Graph
+ * @param from ID of the producing node
+ * @param to ID of the consuming node
+ * @param capacity Minimum number of tokens that the queue can hold
+ * @return ID of the edge, or -1 if the graph is full or the IDs are invalid
+ */
+int rt_graph_add_edge(struct rt_graph *g, int from, int to,
+		      unsigned int capacity);
+
+/**
+ * Allocate the queues and admit the nodes' threads
+ * @param g Graph
+ * @return 0 on success, -1 on error (errno is EINVAL if the graph contains
+ *         a cycle)
+ *
+ * The threads are admitted as one batch (see litmus_threads_create()) and
+ * then wait for a synchronous release, which must be triggered with
+ * release_ts().
+ */
+int rt_graph_start(struct rt_graph *g);
+
+/**
+ * Ask all nodes of a graph to stop
+ * @param g Graph
+ */
+void rt_graph_stop(struct rt_graph *g);
+
+/**
+ * Wait for the threads of a stopped graph and release the queues
+ * @param g Graph
+ */
+void rt_graph_join(struct rt_graph *g);
+
+/**
+ * Determine the critical path
+ * @param g Graph
+ * @return Index into g->paths of the path with the largest maximum
+ *         latency, or -1 if no token has reached a sink yet
+ */
+int rt_graph_critical_path(const struct rt_graph *g);
+
+/**
+ * Print per-path end-to-end latencies and per-edge queueing delays
+ * @param g Graph
+ * @param out Where to print to
+ */
+void rt_graph_report(const struct rt_graph *g, FILE *out);
+
+#endif
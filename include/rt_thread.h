@@ -0,0 +1,130 @@
+/**
+ * @file rt_thread.h
+ * Creation of real-time threads, optionally on prefaulted, locked stacks
+ *
+ * Not included by litmus.h, so that single-threaded programs need not be
+ * built with -pthread. The header can be included together with litmus.h,
+ * <sched.h>, and <pthread.h> in any order.
+ */
+
+#ifndef RT_THREAD_H
+#define RT_THREAD_H
+
+#include <pthread.h>
+
+#include "litmus.h"
+
+/**
+ * Default size of rt_stack allocations
+ */
+#define RT_STACK_DEFAULT_SIZE (128 * 1024)
+
+/**
+ * Number of inaccessible pages below each rt_stack
+ */
+#define RT_STACK_GUARD_PAGES 1
+
+/**
+ * Thread stack in locked memory with a guard area
+ */
+struct rt_stack {
+	char*  base;  /**< Lowest usable address (just above the guard pages) */
+	size_t size;  /**< Usable size in bytes */
+	size_t guard; /**< Size of the guard area below base */
+};
+
+/**
+ * Allocate a prefaulted, locked stack
+ * @param stack Stack descriptor to initialise
+ * @param size Usable stack size in bytes, rounded up to whole pages
+ *        (0 for RT_STACK_DEFAULT_SIZE)
+ * @return 0 on success, -1 on error
+ *
+ * The stack is filled with a canary pattern for rt_stack_high_water(). An
+ * overflow hits the guard pages and raises SIGSEGV instead of silently
+ * corrupting adjacent memory.
+ */
+int rt_stack_alloc(struct rt_stack *stack, size_t size);
+/**
+ * Release a stack
+ * @param stack Stack allocated with rt_stack_alloc(), not in use anymore
+ */
+void rt_stack_free(struct rt_stack *stack);
+/**
+ * Determine the maximum stack depth so far by sweeping for the canary
+ * @param stack Stack allocated with rt_stack_alloc()
+ * @return Number of bytes that have been used (including the thread
+ *         control block and TLS that pthreads places at the top)
+ */
+size_t rt_stack_high_water(const struct rt_stack *stack);
+/**
+ * Create a thread that runs on a given stack
+ * @param thread Where to store the thread ID
+ * @param stack Stack allocated with rt_stack_alloc(); must not be freed
+ *        before the thread has been joined
+ * @param start_routine Thread function
+ * @param arg Argument for start_routine
+ * @return 0 on success, an error number otherwise (like pthread_create())
+ */
+int rt_pthread_create(pthread_t *thread, struct rt_stack *stack,
+		      void *(*start_routine)(void*), void *arg);
+
+/**
+ * Description of a real-time thread for litmus_threads_create()
+ */
+struct litmus_thread_spec {
+	struct rt_task params;  /**< Task parameters of the thread */
+	int domain;             /**< Domain (cluster/partition) to migrate to
+				 *   before admission, or -1 to stay. If set,
+				 *   params.cpu is replaced by the domain's
+				 *   first CPU unless it lies in the domain. */
+	struct rt_stack *stack; /**< Stack to run on, or NULL for a default
+				 *   pthread stack */
+	void* (*start_routine)(void*); /**< Thread function */
+	void* arg;              /**< Argument for start_routine */
+};
+
+/**
+ * Flags for litmus_threads_create()
+ */
+enum litmus_threads_flags {
+	/** Once all threads are admitted, have each of them call
+	 *  wait_for_ts_release() before entering its start_routine. */
+	LITMUS_THREADS_WAIT_RELEASE = 0x1
+};
+
+/**
+ * Create a batch of real-time threads
+ * @param threads Array of n thread IDs to fill in
+ * @param specs Array of n thread descriptions
+ * @param n Number of threads
+ * @param flags Bitwise OR of enum litmus_threads_flags values
+ * @param setup_time If not NULL, receives the time in nanoseconds that it
+ *        took until all threads were admitted
+ * @return 0 if all threads were admitted, -1 otherwise
+ *
+ * Each thread migrates to its domain, sets its task parameters, initialises
+ * liblitmus' per-thread state, and becomes a LITMUS^RT task. Threads set
+ * themselves up in parallel and then wait on an internal barrier, so no
+ * start_routine runs before every thread of the batch has been admitted. If
+ * any thread cannot be admitted, all threads revert to background mode and
+ * exit without running start_routine, and the call returns -1 after joining
+ * them. init_litmus() must have been called before.
+ */
+int litmus_threads_create(pthread_t *threads,
+			  const struct litmus_thread_spec *specs, int n,
+			  int flags, lt_t *setup_time);
+
+/**
+ * Create a single real-time thread
+ * @param thread Where to store the thread ID
+ * @param params Task parameters; the thread migrates to the domain that
+ *        contains params->cpu, if LITMUS^RT reports one
+ * @param start_routine Thread function
+ * @param arg Argument for start_routine
+ * @return 0 if the thread was admitted, -1 otherwise
+ */
+int litmus_thread_create(pthread_t *thread, struct rt_task *params,
+			 void *(*start_routine)(void*), void *arg);
+
+#endif
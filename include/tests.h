@@ -102,4 +102,24 @@ struct testsuite {
  */
 #define FORK_TASK(code) ({int __pid = fork(); if (__pid == 0) {code; exit(0);}; __pid;})
 
+/**
+ * Create a temporary directory for a fake /sys or /proc tree
+ * @param root Template ending in XXXXXX, replaced with the directory name
+ */
+void make_fixture_tree(char *root);
+
+/**
+ * Write a file of a fixture tree, creating its parent directories
+ * @param root Directory created with make_fixture_tree()
+ * @param path Path of the file relative to root
+ * @param content Content of the file
+ */
+void write_fixture(const char *root, const char *path, const char *content);
+
+/**
+ * Remove a fixture tree and everything in it
+ * @param root Directory created with make_fixture_tree()
+ */
+void remove_fixture_tree(const char *root);
+
 #endif
@@ -0,0 +1,125 @@
+/**
+ * @file topology.h
+ * Cache and NUMA topology from sysfs, and advice on cluster sizes
+ *
+ * Clustered schedulers such as C-EDF work best if each cluster consists of
+ * the CPUs that share a cache: tasks then migrate only among CPUs that
+ * share their cache contents. This module reads which CPUs share each
+ * cache level from /sys/devices/system/cpu/cpu<n>/cache, and which CPUs
+ * belong to each NUMA node from /sys/devices/system/node. From this, it
+ * derives the cluster sizes that align with cache or node boundaries, and
+ * it detects scheduling domains that straddle such boundaries.
+ *
+ * Like the rest of liblitmus, CPU sets are bit masks of at most 64 CPUs.
+ * All functions that read sysfs take its root as the first argument (NULL
+ * for /sys), so that they can work on a copy of the tree.
+ */
+
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOPOLOGY_MAX_CPUS   64 /**< CPUs supported */
+#define TOPOLOGY_MAX_LEVELS 4  /**< Deepest cache level considered */
+#define TOPOLOGY_MAX_ADVICE 8  /**< Entries of a cluster size advice */
+
+/**
+ * Cache and node topology of a machine
+ */
+struct cpu_topology {
+	/** CPUs found in sysfs */
+	unsigned long long cpus;
+	/** Deepest cache level found, 0 if no cache information exists */
+	int levels;
+	/** cache[l][c]: CPUs sharing CPU c's level-l data or unified cache;
+	 *  0 if CPU c has no such cache */
+	unsigned long long cache[TOPOLOGY_MAX_LEVELS + 1][TOPOLOGY_MAX_CPUS];
+	/** node[c]: CPUs on the NUMA node of CPU c; 0 if unknown */
+	unsigned long long node[TOPOLOGY_MAX_CPUS];
+};
+
+/**
+ * Read the topology of a machine
+ * @param sys_root Root of the sysfs tree, or NULL for /sys
+ * @param t Where to store the topology
+ * @return 0 on success, -1 if no CPU could be found
+ */
+int read_cpu_topology(const char *sys_root, struct cpu_topology *t);
+
+/**
+ * List the distinct caches of one level, or the NUMA nodes
+ * @param t Topology read with read_cpu_topology()
+ * @param level Cache level, or 0 for NUMA nodes
+ * @param groups Where to store the CPU set of each cache or node, ordered
+ *        by their lowest CPU
+ * @param max Number of entries in groups
+ * @return Number of groups found (possibly more than max)
+ */
+int topology_groups(const struct cpu_topology *t, int level,
+		    unsigned long long *groups, int max);
+
+/**
+ * Find the smallest cache that all CPUs of a set share
+ * @param t Topology read with read_cpu_topology()
+ * @param cpus CPU set, e.g., of a scheduling domain
+ * @return The lowest cache level at which all of cpus share one cache, or 0
+ *         if they do not share any cache
+ */
+int shared_cache_level(const struct cpu_topology *t, unsigned long long cpus);
+
+/**
+ * Find a cache level at which a set of CPUs includes only part of a cache
+ * @param t Topology read with read_cpu_topology()
+ * @param cpus CPU set, e.g., of a scheduling domain
+ * @return The lowest cache level below shared_cache_level() (or at any
+ *         level, if cpus share no cache) at which cpus include some, but
+ *         not all CPUs of a cache; 0 if they consist of whole caches at
+ *         every such level
+ *
+ * A domain that splits a cache, e.g., one that consists of one CPU of each
+ * of two L2 caches, competes for that cache with CPUs of another domain.
+ */
+int split_cache_level(const struct cpu_topology *t, unsigned long long cpus);
+
+/**
+ * Whether a set of CPUs spans several NUMA nodes
+ * @param t Topology read with read_cpu_topology()
+ * @param cpus CPU set, e.g., of a scheduling domain
+ * @return 1 if cpus belong to more than one node, 0 otherwise
+ */
+int spans_nodes(const struct cpu_topology *t, unsigned long long cpus);
+
+/**
+ * A cluster size that aligns with the topology
+ */
+struct cluster_advice {
+	int size;        /**< CPUs per cluster */
+	int nclusters;   /**< Number of clusters */
+	int level;       /**< Cache level that the clusters correspond to, 0
+			  *   if they correspond to no shared cache */
+	const char *why; /**< Description, e.g., "shared L2" or "NUMA node" */
+};
+
+/**
+ * Recommend cluster sizes
+ * @param t Topology read with read_cpu_topology()
+ * @param advice Where to store the recommendations, by increasing size
+ * @param max Number of entries in advice
+ * @return Number of recommendations stored
+ *
+ * A size is recommended if all caches of some level (or all nodes) contain
+ * the same number of CPUs and together contain all CPUs, so that clusters
+ * of this size coincide with them. Partitioning (size 1) and global
+ * scheduling (all CPUs) are always included.
+ */
+int recommend_cluster_sizes(const struct cpu_topology *t,
+			    struct cluster_advice *advice, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,164 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "litmus.h"
+#include "arena.h"
+
+#define ALIGN_UP(x, a) (((x) + (a) - 1) & ~((size_t) (a) - 1))
+
+/* thread-local default arena for rt_malloc() */
+static __thread struct rt_arena *thread_arena;
+
+int rt_arena_init(struct rt_arena *arena, size_t size)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	void *mem;
+	size_t i;
+	int err;
+
+	memset(arena, 0, sizeof(*arena));
+	if (!size) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	size = ALIGN_UP(size, page_size);
+	mem = mmap(NULL, size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+	if (mem == MAP_FAILED)
+		return -1;
+
+	if (mlock(mem, size) != 0) {
+		err = errno;
+		munmap(mem, size);
+		errno = err;
+		return -1;
+	}
+
+	/* Write to every page so that no copy-on-write or zero-page fault
+	 * can happen later on. */
+	for (i = 0; i < size; i += page_size)
+		((volatile char*) mem)[i] = 0;
+
+	arena->base = mem;
+	arena->size = size;
+	return 0;
+}
+
+void rt_arena_destroy(struct rt_arena *arena)
+{
+	if (arena->base) {
+		munlock(arena->base, arena->size);
+		munmap(arena->base, arena->size);
+	}
+	if (thread_arena == arena)
+		thread_arena = NULL;
+	memset(arena, 0, sizeof(*arena));
+}
+
+void* rt_arena_alloc(struct rt_arena *arena, size_t size)
+{
+	size_t start = ALIGN_UP(arena->used, RT_ARENA_ALIGN);
+
+	if (start > arena->size || size > arena->size - start)
+		return NULL;
+
+	arena->used = start + size;
+	if (arena->used > arena->high_water)
+		arena->high_water = arena->used;
+	return arena->base + start;
+}
+
+void rt_arena_reset(struct rt_arena *arena)
+{
+	arena->used = 0;
+}
+
+int rt_pool_init(struct rt_pool *pool, size_t obj_size, size_t count)
+{
+	size_t i;
+	void *obj;
+
+	memset(pool, 0, sizeof(*pool));
+	if (!count) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	/* free objects store the free-list link in their first word */
+	if (obj_size < sizeof(void*))
+		obj_size = sizeof(void*);
+	if (obj_size > SIZE_MAX - RT_ARENA_ALIGN) {
+		errno = EOVERFLOW;
+		return -1;
+	}
+	obj_size = ALIGN_UP(obj_size, RT_ARENA_ALIGN);
+	if (count > SIZE_MAX / obj_size) {
+		errno = EOVERFLOW;
+		return -1;
+	}
+
+	if (rt_arena_init(&pool->arena, obj_size * count) != 0)
+		return -1;
+
+	pool->obj_size = obj_size;
+	pool->count    = count;
+
+	/* thread the free list in reverse so that allocation order follows
+	 * addresses */
+	for (i = count; i > 0; i--) {
+		obj = pool->arena.base + (i - 1) * obj_size;
+		*(void**) obj = pool->free_list;
+		pool->free_list = obj;
+	}
+	pool->arena.used = pool->arena.high_water = obj_size * count;
+	return 0;
+}
+
+void rt_pool_destroy(struct rt_pool *pool)
+{
+	rt_arena_destroy(&pool->arena);
+	memset(pool, 0, sizeof(*pool));
+}
+
+void* rt_pool_alloc(struct rt_pool *pool)
+{
+	void *obj = pool->free_list;
+
+	if (obj) {
+		pool->free_list = *(void**) obj;
+		pool->in_use++;
+		if (pool->in_use > pool->high_water)
+			pool->high_water = pool->in_use;
+	}
+	return obj;
+}
+
+void rt_pool_free(struct rt_pool *pool, void *obj)
+{
+	if (obj) {
+		*(void**) obj = pool->free_list;
+		pool->free_list = obj;
+		pool->in_use--;
+	}
+}
+
+void set_thread_arena(struct rt_arena *arena)
+{
+	thread_arena = arena;
+}
+
+struct rt_arena* get_thread_arena(void)
+{
+	return thread_arena;
+}
+
+void* rt_malloc(size_t size)
+{
+	if (!thread_arena)
+		return NULL;
+	return rt_arena_alloc(thread_arena, size);
+}
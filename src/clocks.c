@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <errno.h>
 
 #include <sys/time.h>
 #include <time.h>
@@ -24,11 +25,96 @@ double wctime(void)
 	return (tv.tv_sec + 1E-6 * tv.tv_usec);
 }
 
+static inline lt_t timespec2ns(const struct timespec *ts)
+{
+	return s2ns((lt_t) ts->tv_sec) + ts->tv_nsec;
+}
+
+static inline void ns2timespec(lt_t ns, struct timespec *ts)
+{
+	ts->tv_sec  = ns / 1000000000L;
+	ts->tv_nsec = ns % 1000000000L;
+}
+
+/* CLOCK_MONOTONIC is served from the vDSO, i.e., without entering the
+ * kernel. It is also the time base of LITMUS^RT job releases. */
+lt_t monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return timespec2ns(&ts);
+}
+
+lt_t thread_cputime_ns(void)
+{
+	struct timespec ts;
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+		perror("clock_gettime");
+		return 0;
+	}
+	return timespec2ns(&ts);
+}
+
 int lt_sleep(lt_t timeout)
 {
 	struct timespec delay;
 
-	delay.tv_sec  = timeout / 1000000000L;
-	delay.tv_nsec = timeout % 1000000000L;
+	ns2timespec(timeout, &delay);
 	return nanosleep(&delay, NULL);
 }
+
+int lt_sleep_until(lt_t wake_time)
+{
+	struct timespec ts;
+	int err;
+
+	ns2timespec(wake_time, &ts);
+	/* absolute sleeps can simply be restarted after a signal */
+	do {
+		err = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+	} while (err == EINTR);
+
+	if (err) {
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+int init_periodic_timer(struct periodic_timer *t, lt_t first_release,
+			lt_t period)
+{
+	if (!period) {
+		errno = EINVAL;
+		return -1;
+	}
+	t->next_release = first_release ? first_release : monotonic_ns();
+	t->period       = period;
+	t->releases     = 0;
+	t->overruns     = 0;
+	t->missed       = 0;
+	return 0;
+}
+
+int sleep_next_release(struct periodic_timer *t)
+{
+	lt_t now = monotonic_ns();
+	unsigned long missed = 0;
+
+	if (now <= t->next_release) {
+		if (lt_sleep_until(t->next_release) != 0)
+			return -1;
+	} else {
+		/* The previous job overran its period. Skip over all releases
+		 * that already passed, except for the most recent one, so that
+		 * the phase is preserved. */
+		t->overruns++;
+		missed = (now - t->next_release) / t->period;
+		t->missed += missed;
+		t->next_release += missed * t->period;
+	}
+
+	t->releases++;
+	t->next_release += t->period;
+	return missed;
+}
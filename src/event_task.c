@@ -0,0 +1,109 @@
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+
+#include "litmus.h"
+#include "event_task.h"
+
+int init_event_task(struct event_task *et, int fd,
+		    enum event_source_mode mode, event_handler_t handler,
+		    void *arg)
+{
+	struct rt_task params;
+
+	memset(et, 0, sizeof(*et));
+	if (get_rt_task_param(gettid(), &params) != 0)
+		return -1;
+	if (params.release_policy != TASK_SPORADIC) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	et->fd      = fd;
+	et->mode    = mode;
+	et->handler = handler;
+	et->arg     = arg;
+	et->min_interarrival = params.period;
+	return 0;
+}
+
+/* 1 if readable, 0 on timeout, -1 on error or if the source was closed */
+static int wait_readable(int fd, int timeout_ms)
+{
+	struct pollfd pfd;
+	int ret;
+
+	pfd.fd     = fd;
+	pfd.events = POLLIN;
+	do {
+		ret = poll(&pfd, 1, timeout_ms);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret > 0 && !(pfd.revents & POLLIN)) {
+		/* hang-up or error without pending data */
+		errno = EPIPE;
+		return -1;
+	}
+	return ret;
+}
+
+/* read and account the pending events of an eventfd */
+static int read_eventfd(struct event_task *et, uint64_t *events)
+{
+	uint64_t count;
+
+	if (read(et->fd, &count, sizeof(count)) != sizeof(count))
+		return -1;
+
+	et->stats.events    += count;
+	et->stats.coalesced += count - 1;
+	if (et->max_events && count > et->max_events) {
+		et->stats.dropped += count - et->max_events;
+		count = et->max_events;
+	}
+	*events = count;
+	return 0;
+}
+
+int run_event_task(struct event_task *et)
+{
+	uint64_t events = 0;
+	lt_t now, earliest;
+	int pending, done;
+
+	do {
+		/* Events that are pending already arrived while the previous
+		 * job executed or waited for its next release. */
+		pending = wait_readable(et->fd, 0);
+		if (pending < 0 || (!pending && wait_readable(et->fd, -1) < 0))
+			return -1;
+
+		now = monotonic_ns();
+		earliest = et->last_start + et->min_interarrival;
+		if (et->stats.jobs && now < earliest) {
+			if (lt_sleep_until(earliest) != 0)
+				return -1;
+			if (earliest - now > et->stats.max_delay)
+				et->stats.max_delay = earliest - now;
+			pending = 1;
+			now = monotonic_ns();
+		}
+		if (pending && et->stats.jobs)
+			et->stats.delayed++;
+		et->last_start = now;
+
+		if (et->mode == EVENT_SOURCE_EVENTFD &&
+		    read_eventfd(et, &events) != 0)
+			return -1;
+
+		done = et->handler(et->fd, events, et->arg);
+		et->stats.jobs++;
+
+		if (!done && sleep_next_period() != 0)
+			return -1;
+	} while (!done);
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "exec_estimator.h"
+
+/* The quantile sketch is the P-square algorithm of Jain and Chlamtac (CACM,
+ * 1985): five markers track the minimum, the p/2, p, and (1+p)/2 quantiles,
+ * and the maximum; their heights are adjusted with piecewise-parabolic
+ * interpolation as samples arrive. */
+
+void init_exec_estimator(struct exec_estimator *est, double quantile,
+			 unsigned int ewma_shift)
+{
+	memset(est, 0, sizeof(*est));
+	est->quantile   = quantile;
+	est->ewma_shift = ewma_shift;
+}
+
+static void sort_initial_samples(struct exec_estimator *est, int count)
+{
+	int i, j;
+	double tmp;
+
+	for (i = 1; i < count; i++)
+		for (j = i; j > 0 && est->q[j - 1] > est->q[j]; j--) {
+			tmp = est->q[j];
+			est->q[j] = est->q[j - 1];
+			est->q[j - 1] = tmp;
+		}
+}
+
+static double parabolic(const struct exec_estimator *est, int i, int d)
+{
+	const double *q = est->q;
+	const int *n = est->n;
+
+	return q[i] + (double) d / (n[i + 1] - n[i - 1]) *
+		((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+		 (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+static double linear(const struct exec_estimator *est, int i, int d)
+{
+	return est->q[i] + d * (est->q[i + d] - est->q[i]) /
+		(est->n[i + d] - est->n[i]);
+}
+
+static void sketch_add(struct exec_estimator *est, double x)
+{
+	double p = est->quantile;
+	double dn[5] = {0, p / 2, p, (1 + p) / 2, 1};
+	double qp, delta;
+	int i, k, d;
+
+	if (est->samples < 5) {
+		est->q[est->samples] = x;
+		if (est->samples == 4) {
+			sort_initial_samples(est, 5);
+			for (i = 0; i < 5; i++)
+				est->n[i] = i;
+			est->np[0] = 0;
+			est->np[1] = 2 * p;
+			est->np[2] = 4 * p;
+			est->np[3] = 2 + 2 * p;
+			est->np[4] = 4;
+		}
+		return;
+	}
+
+	/* find the cell that x falls into, extending the extremes */
+	if (x < est->q[0]) {
+		est->q[0] = x;
+		k = 0;
+	} else if (x >= est->q[4]) {
+		est->q[4] = x;
+		k = 3;
+	} else
+		for (k = 0; k < 3 && x >= est->q[k + 1]; k++)
+			;
+
+	for (i = k + 1; i < 5; i++)
+		est->n[i]++;
+	for (i = 0; i < 5; i++)
+		est->np[i] += dn[i];
+
+	/* adjust the inner markers if they are off by one or more */
+	for (i = 1; i < 4; i++) {
+		delta = est->np[i] - est->n[i];
+		if ((delta >= 1 && est->n[i + 1] - est->n[i] > 1) ||
+		    (delta <= -1 && est->n[i - 1] - est->n[i] < -1)) {
+			d = delta > 0 ? 1 : -1;
+			qp = parabolic(est, i, d);
+			if (est->q[i - 1] < qp && qp < est->q[i + 1])
+				est->q[i] = qp;
+			else
+				est->q[i] = linear(est, i, d);
+			est->n[i] += d;
+		}
+	}
+}
+
+void exec_estimator_add(struct exec_estimator *est, lt_t exec_time)
+{
+	sketch_add(est, (double) exec_time);
+
+	if (!est->samples)
+		est->ewma = exec_time;
+	else
+		est->ewma = (lt_t) ((int64_t) est->ewma +
+			(((int64_t) exec_time - (int64_t) est->ewma)
+			 >> est->ewma_shift));
+	if (exec_time > est->max)
+		est->max = exec_time;
+	est->samples++;
+}
+
+lt_t exec_estimate_quantile(const struct exec_estimator *est)
+{
+	struct exec_estimator tmp;
+	int count, rank;
+
+	if (!est->samples)
+		return 0;
+	if (est->samples >= 5)
+		return (lt_t) est->q[2];
+
+	/* too few samples for the sketch: nearest rank */
+	count = est->samples;
+	tmp = *est;
+	sort_initial_samples(&tmp, count);
+	rank = (int) (est->quantile * count);
+	if (rank < est->quantile * count)
+		rank++;
+	if (rank < 1)
+		rank = 1;
+	return (lt_t) tmp.q[rank - 1];
+}
+
+lt_t recommend_exec_cost(const struct exec_estimator *est,
+			 const struct exec_budget_policy *policy,
+			 lt_t current)
+{
+	lt_t rec, diff;
+
+	if (!est->samples || est->samples < policy->warmup)
+		return current;
+
+	switch (policy->estimate) {
+	case EXEC_EST_EWMA:
+		rec = est->ewma;
+		break;
+	case EXEC_EST_MAX:
+		rec = est->max;
+		break;
+	case EXEC_EST_QUANTILE:
+	default:
+		rec = exec_estimate_quantile(est);
+		break;
+	}
+
+	rec += rec * policy->margin_pct / 100;
+	if (rec < policy->min_budget)
+		rec = policy->min_budget;
+	if (policy->max_budget && rec > policy->max_budget)
+		rec = policy->max_budget;
+
+	if ((policy->flags & EXEC_BUDGET_NO_SHRINK) && rec < current)
+		return current;
+	if ((policy->flags & EXEC_BUDGET_NO_GROW) && rec > current)
+		return current;
+
+	diff = rec > current ? rec - current : current - rec;
+	if (diff * 100 <= current * policy->hysteresis_pct)
+		return current;
+
+	return rec;
+}
+
+int apply_exec_cost(lt_t exec_cost)
+{
+	struct rt_task params;
+
+	if (get_rt_task_param(gettid(), &params) != 0)
+		return -1;
+	if (params.exec_cost == exec_cost)
+		return 0;
+	params.exec_cost = exec_cost;
+	return change_rt_task_param(&params, -1);
+}
@@ -0,0 +1,200 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "litmus.h"
+#include "fork_join.h"
+
+/* barrier polls before suspending in the kernel */
+#define FORK_JOIN_SPIN 1000
+
+struct worker {
+	struct fork_join *fj;
+	int index;
+};
+
+static void futex_wait(volatile int *addr, int val)
+{
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake_all(volatile int *addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+}
+
+/* Sense-reversing barrier. The last worker to arrive completes the job on
+ * behalf of all of them and publishes whether to stop. */
+static int barrier_wait(struct fork_join *fj, int *sense, lt_t now)
+{
+	int i;
+	lt_t span;
+
+	*sense = !*sense;
+	if (__sync_sub_and_fetch(&fj->remaining, 1) == 0) {
+		span = now - fj->job_start;
+		fj->jobs++;
+		fj->span_total += span;
+		if (span > fj->span_max)
+			fj->span_max = span;
+		fj->job_start = 0;
+		fj->stopping  = fj->stop;
+		fj->remaining = fj->nworkers;
+		__sync_synchronize();
+		fj->sense = *sense;
+		futex_wake_all(&fj->sense);
+	} else {
+		for (i = 0; i < FORK_JOIN_SPIN && fj->sense != *sense; i++)
+			__sync_synchronize();
+		while (fj->sense != *sense)
+			futex_wait(&fj->sense, !*sense);
+	}
+	__sync_synchronize();
+	return fj->stopping;
+}
+
+/* Called by a worker that cannot complete its job. The others would wait
+ * for it at the barrier forever, so release them from the barrier of the
+ * current job and have all workers stop. sense is the failed worker's sense
+ * of the last barrier it passed, which the others have passed as well. */
+static void barrier_abort(struct fork_join *fj, int sense, int error)
+{
+	__sync_bool_compare_and_swap(&fj->error, 0, error ? error : EINVAL);
+	fj->stop      = 1;
+	fj->stopping  = 1;
+	__sync_synchronize();
+	fj->sense = !sense;
+	futex_wake_all(&fj->sense);
+}
+
+static void* worker_main(void *_w)
+{
+	struct worker *w = _w;
+	struct fork_join *fj = w->fj;
+	struct fork_join_worker_stats *stats = fj->stats + w->index;
+	unsigned int job_no = 0;
+	lt_t start, end, joined;
+	int sense = 0, stop = 0;
+
+	/* the first job starts at the synchronous release */
+	for (;;) {
+		if (get_job_no(&job_no) != 0)
+			break;
+		start = monotonic_ns();
+		__sync_bool_compare_and_swap(&fj->job_start, 0, start);
+
+		fj->work(w->index, fj->nworkers, job_no, fj->arg);
+
+		end = monotonic_ns();
+		stop = barrier_wait(fj, &sense, end);
+		joined = monotonic_ns();
+
+		stats->jobs++;
+		stats->busy_total += end - start;
+		if (end - start > stats->busy_max)
+			stats->busy_max = end - start;
+		stats->wait_total += joined - end;
+		if (joined - end > stats->wait_max)
+			stats->wait_max = joined - end;
+
+		if (stop || sleep_next_period() != 0)
+			break;
+	}
+	if (!stop)
+		barrier_abort(fj, sense, errno);
+
+	task_mode(BACKGROUND_TASK);
+	return NULL;
+}
+
+int fork_join_create(struct fork_join *fj, int domain,
+		     const struct rt_task *params, fork_join_fn_t work,
+		     void *arg)
+{
+	struct litmus_thread_spec *specs;
+	struct worker *workers;
+	unsigned long long cpus;
+	int i, cpu, n;
+
+	memset(fj, 0, sizeof(*fj));
+	if (domain_to_cpus(domain, &cpus) != 0)
+		return -1;
+	n = __builtin_popcountll(cpus);
+	if (!n) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	fj->nworkers  = n;
+	fj->work      = work;
+	fj->arg       = arg;
+	fj->remaining = n;
+
+	specs   = calloc(n, sizeof(*specs));
+	workers = calloc(n, sizeof(*workers));
+	fj->threads = calloc(n, sizeof(*fj->threads));
+	if (posix_memalign((void**) &fj->stats, FORK_JOIN_CACHE_LINE,
+			   n * sizeof(*fj->stats)) != 0)
+		fj->stats = NULL;
+	if (!specs || !workers || !fj->threads || !fj->stats)
+		goto fail;
+	memset(fj->stats, 0, n * sizeof(*fj->stats));
+
+	for (i = 0, cpu = 0; i < n; i++, cpu++) {
+		while (!(cpus & (1ULL << cpu)))
+			cpu++;
+		workers[i].fj    = fj;
+		workers[i].index = i;
+		fj->stats[i].cpu = cpu;
+		specs[i].params  = *params;
+		specs[i].params.cpu = cpu;
+		specs[i].domain  = domain;
+		specs[i].stack   = NULL;
+		specs[i].start_routine = worker_main;
+		specs[i].arg     = workers + i;
+	}
+
+	if (litmus_threads_create(fj->threads, specs, n,
+				  LITMUS_THREADS_WAIT_RELEASE, NULL) != 0)
+		goto fail;
+
+	free(specs);
+	fj->workers = workers;
+	return 0;
+
+fail:
+	free(specs);
+	free(workers);
+	free(fj->threads);
+	free(fj->stats);
+	fj->threads = NULL;
+	fj->stats = NULL;
+	return -1;
+}
+
+void fork_join_stop(struct fork_join *fj)
+{
+	fj->stop = 1;
+}
+
+void fork_join_join(struct fork_join *fj)
+{
+	int i;
+
+	for (i = 0; i < fj->nworkers; i++)
+		pthread_join(fj->threads[i], NULL);
+}
+
+void fork_join_destroy(struct fork_join *fj)
+{
+	free(fj->threads);
+	free(fj->workers);
+	free(fj->stats);
+	fj->threads = NULL;
+	fj->workers = NULL;
+	fj->stats = NULL;
+}
@@ -0,0 +1,305 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "irq_shield.h"
+
+#define DEFAULT_PROC_ROOT "/proc"
+
+/* enough for 4096 CPUs (4 CPUs per hex digit, a comma per 8 digits); must
+ * match the field width in restore_irq_affinity() */
+#define MASK_LEN 1201
+
+static const char* root_of(const char *proc_root)
+{
+	return proc_root ? proc_root : DEFAULT_PROC_ROOT;
+}
+
+static int read_mask(const char *fname, char *mask)
+{
+	ssize_t len = read_file(fname, mask, MASK_LEN - 1);
+
+	if (len <= 0)
+		return -1;
+	mask[len] = '\0';
+	while (len && isspace((unsigned char) mask[len - 1]))
+		mask[--len] = '\0';
+	return len ? 0 : -1;
+}
+
+static int write_mask(const char *fname, const char *mask)
+{
+	size_t len = strlen(mask);
+	int fd, ok;
+
+	fd = open(fname, O_WRONLY | O_TRUNC);
+	if (fd < 0)
+		return -1;
+	ok = write(fd, mask, len) == (ssize_t) len;
+	/* procfs reports rejected masks on close as well */
+	if (close(fd) != 0)
+		ok = 0;
+	return ok ? 0 : -1;
+}
+
+static int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	c = tolower((unsigned char) c);
+	return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+/* Clear the CPUs in cpus from a mask in the kernel's format (hex digits,
+ * most significant first, in comma-separated groups of eight). The mask is
+ * edited in place, so it keeps its width. Returns whether any CPU remains. */
+static int clear_cpus(char *mask, unsigned long long cpus)
+{
+	static const char digits[] = "0123456789abcdef";
+	int i, digit = 0, remains = 0, val, shift;
+
+	for (i = strlen(mask) - 1; i >= 0; i--) {
+		val = hex_value(mask[i]);
+		if (val < 0)
+			continue;
+		shift = 4 * digit++;
+		if (shift < 64)
+			val &= ~(int) ((cpus >> shift) & 0xf);
+		mask[i] = digits[val];
+		remains |= val;
+	}
+	return remains != 0;
+}
+
+static int intersects(const char *mask, unsigned long long cpus)
+{
+	int i, digit = 0, val, shift;
+
+	for (i = strlen(mask) - 1; i >= 0; i--) {
+		val = hex_value(mask[i]);
+		if (val < 0)
+			continue;
+		shift = 4 * digit++;
+		if (shift < 64 && (val & ((cpus >> shift) & 0xf)))
+			return 1;
+	}
+	return 0;
+}
+
+static void count(struct irq_shield_result *result, int outcome)
+{
+	if (!result)
+		return;
+	if (outcome < 0)
+		result->failed++;
+	else if (outcome)
+		result->changed++;
+	else
+		result->unchanged++;
+}
+
+/* Returns 1 if the mask was changed, 0 if not needed, -1 on failure. */
+static int shield_one(const char *fname, unsigned long long cpus,
+		      const char *fallback)
+{
+	char mask[MASK_LEN];
+
+	if (read_mask(fname, mask) != 0)
+		return -1;
+	if (!intersects(mask, cpus))
+		return 0;
+	if (!clear_cpus(mask, cpus)) {
+		if (!fallback)
+			return -1;
+		/* nothing left: use the (already shielded) default */
+		strcpy(mask, fallback);
+	}
+	return write_mask(fname, mask) == 0 ? 1 : -1;
+}
+
+static int is_irq_dir(const struct dirent *d)
+{
+	const char *c = d->d_name;
+
+	if (!*c)
+		return 0;
+	for (; *c; c++)
+		if (!isdigit((unsigned char) *c))
+			return 0;
+	return 1;
+}
+
+int irq_shield_cpus(const char *proc_root, unsigned long long cpus,
+		    struct irq_shield_result *result)
+{
+	char fname[4096], fallback[MASK_LEN];
+	const char *root = root_of(proc_root);
+	struct dirent *d;
+	DIR *dir;
+	int outcome, failed = 0, have_fallback;
+
+	if (result)
+		memset(result, 0, sizeof(*result));
+
+	snprintf(fname, sizeof(fname), "%s/irq/default_smp_affinity", root);
+	outcome = shield_one(fname, cpus, NULL);
+	count(result, outcome);
+	failed |= outcome < 0;
+	have_fallback = outcome >= 0 && read_mask(fname, fallback) == 0;
+
+	snprintf(fname, sizeof(fname), "%s/irq", root);
+	dir = opendir(fname);
+	if (!dir)
+		return -1;
+	while ((d = readdir(dir)) != NULL) {
+		if (!is_irq_dir(d))
+			continue;
+		snprintf(fname, sizeof(fname), "%s/irq/%s/smp_affinity",
+			 root, d->d_name);
+		outcome = shield_one(fname, cpus,
+				     have_fallback ? fallback : NULL);
+		count(result, outcome);
+		failed |= outcome < 0;
+	}
+	closedir(dir);
+	return failed ? -1 : 0;
+}
+
+int irq_shield_domains(const char *proc_root, const int *domains,
+		       int ndomains, struct irq_shield_result *result)
+{
+	unsigned long long cpus = 0, mask;
+	int i;
+
+	for (i = 0; i < ndomains; i++) {
+		if (domain_to_cpus(domains[i], &mask) != 0) {
+			errno = EINVAL;
+			return -1;
+		}
+		cpus |= mask;
+	}
+	return irq_shield_cpus(proc_root, cpus, result);
+}
+
+int save_irq_affinity(const char *proc_root, FILE *out)
+{
+	char fname[4096], mask[MASK_LEN];
+	const char *root = root_of(proc_root);
+	struct dirent *d;
+	DIR *dir;
+
+	snprintf(fname, sizeof(fname), "%s/irq/default_smp_affinity", root);
+	if (read_mask(fname, mask) != 0)
+		return -1;
+	fprintf(out, "default %s\n", mask);
+
+	snprintf(fname, sizeof(fname), "%s/irq", root);
+	dir = opendir(fname);
+	if (!dir)
+		return -1;
+	while ((d = readdir(dir)) != NULL) {
+		if (!is_irq_dir(d))
+			continue;
+		snprintf(fname, sizeof(fname), "%s/irq/%s/smp_affinity",
+			 root, d->d_name);
+		/* interrupts may disappear while we look */
+		if (read_mask(fname, mask) == 0)
+			fprintf(out, "%s %s\n", d->d_name, mask);
+	}
+	closedir(dir);
+	return ferror(out) ? -1 : 0;
+}
+
+int restore_irq_affinity(const char *proc_root, FILE *in,
+			 struct irq_shield_result *result)
+{
+	char fname[4096], name[32], mask[MASK_LEN], current[MASK_LEN];
+	const char *root = root_of(proc_root);
+	int outcome, failed = 0;
+
+	if (result)
+		memset(result, 0, sizeof(*result));
+
+	while (fscanf(in, "%31s %1200s", name, mask) == 2) {
+		if (!strcmp(name, "default"))
+			snprintf(fname, sizeof(fname),
+				 "%s/irq/default_smp_affinity", root);
+		else
+			snprintf(fname, sizeof(fname),
+				 "%s/irq/%s/smp_affinity", root, name);
+		if (read_mask(fname, current) == 0 && !strcmp(current, mask))
+			outcome = 0;
+		else
+			outcome = write_mask(fname, mask) == 0 ? 1 : -1;
+		count(result, outcome);
+		failed |= outcome < 0;
+	}
+	return failed || ferror(in) ? -1 : 0;
+}
+
+int read_irq_counts(const char *proc_root, uint64_t *counts, int max_cpus)
+{
+	char fname[4096], *line = NULL, *pos, *end;
+	int *cpu_of = NULL, ncols = 0, col, ncpus = 0, ret = -1;
+	uint64_t *row = NULL;
+	size_t len = 0;
+	FILE *f;
+
+	snprintf(fname, sizeof(fname), "%s/interrupts", root_of(proc_root));
+	f = fopen(fname, "r");
+	if (!f)
+		return -1;
+	memset(counts, 0, max_cpus * sizeof(*counts));
+
+	/* header: one "CPUn" column per online CPU */
+	if (getline(&line, &len, f) < 0)
+		goto out;
+	cpu_of = calloc(strlen(line) / 4 + 1, sizeof(*cpu_of));
+	row = calloc(strlen(line) / 4 + 1, sizeof(*row));
+	if (!cpu_of || !row)
+		goto out;
+	for (pos = strstr(line, "CPU"); pos; pos = strstr(pos, "CPU")) {
+		pos += 3;
+		cpu_of[ncols] = strtol(pos, &end, 10);
+		if (end == pos || cpu_of[ncols] < 0)
+			goto out;
+		if (cpu_of[ncols] >= ncpus)
+			ncpus = cpu_of[ncols] + 1;
+		ncols++;
+	}
+	if (!ncols || ncpus > max_cpus)
+		goto out;
+
+	while (getline(&line, &len, f) >= 0) {
+		pos = strchr(line, ':');
+		if (!pos)
+			continue;
+		pos++;
+		for (col = 0; col < ncols; col++) {
+			row[col] = strtoull(pos, &end, 10);
+			if (end == pos)
+				break;
+			pos = end;
+		}
+		/* skip summary rows such as ERR and MIS */
+		if (col < ncols)
+			continue;
+		for (col = 0; col < ncols; col++)
+			counts[cpu_of[col]] += row[col];
+	}
+	ret = ncpus;
+
+out:
+	free(line);
+	free(cpu_of);
+	free(row);
+	fclose(f);
+	return ret;
+}
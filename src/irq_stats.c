@@ -0,0 +1,100 @@
+#include <string.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "irq_stats.h"
+
+int init_irq_stats(struct irq_stats *stats, lt_t irq_cost)
+{
+	memset(stats, 0, sizeof(*stats));
+	stats->irq_cost = irq_cost;
+	return get_ctrl_page() ? 0 : -1;
+}
+
+void irq_job_begin(struct irq_stats *stats)
+{
+	stats->irq_start = get_ctrl_page()->irq_count;
+}
+
+uint64_t irq_job_end(struct irq_stats *stats)
+{
+	uint64_t irqs = get_ctrl_page()->irq_count - stats->irq_start;
+	lt_t lost = irqs * stats->irq_cost;
+
+	stats->jobs++;
+	if (irqs) {
+		stats->jobs_hit++;
+		stats->irqs += irqs;
+		if (irqs > stats->max_irqs)
+			stats->max_irqs = irqs;
+		stats->lost_total += lost;
+		if (lost > stats->lost_max)
+			stats->lost_max = lost;
+	}
+	return irqs;
+}
+
+lt_t calibrate_irq_cost(lt_t duration)
+{
+	struct control_page *cp = get_ctrl_page();
+	lt_t prev, now, end, gap, min_gap = (lt_t) -1, lost = 0;
+	uint64_t count, last, irqs = 0, gaps = 0;
+
+	if (!cp)
+		return 0;
+
+	last = cp->irq_count;
+	prev = monotonic_ns();
+	end  = prev + duration;
+	do {
+		count = cp->irq_count;
+		now   = monotonic_ns();
+		gap   = now - prev;
+		if (count != last) {
+			irqs += count - last;
+			lost += gap;
+			gaps++;
+			last = count;
+		} else if (gap < min_gap) {
+			min_gap = gap;
+		}
+		prev = now;
+	} while (now < end);
+
+	if (!irqs)
+		return 0;
+	/* the loop itself takes min_gap per iteration */
+	if (min_gap != (lt_t) -1 && lost > gaps * min_gap)
+		lost -= gaps * min_gap;
+	return lost / irqs;
+}
+
+int measure_syscall_entry(struct syscall_entry_stats *stats, int samples)
+{
+	struct control_page *cp = get_ctrl_page();
+	cycles_t entered, latency;
+	int i;
+
+	memset(stats, 0, sizeof(*stats));
+	if (!cp)
+		return -1;
+
+	for (i = 0; i < samples; i++) {
+		cp->irq_syscall_start = cp->irq_count;
+		cp->ts_syscall_start  = get_cycles();
+		if (null_call(&entered) != 0)
+			return -1;
+		if (cp->irq_count != cp->irq_syscall_start) {
+			stats->disturbed++;
+			continue;
+		}
+		latency = entered - cp->ts_syscall_start;
+		if (!stats->samples || latency < stats->min)
+			stats->min = latency;
+		if (latency > stats->max)
+			stats->max = latency;
+		stats->total += latency;
+		stats->samples++;
+	}
+	return 0;
+}
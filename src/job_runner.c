@@ -0,0 +1,221 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "job_runner.h"
+#include "exec_estimator.h"
+#include "mode_change.h"
+#include "mk_firm.h"
+
+static void set_timing_params(struct job_runner *runner,
+			      const struct rt_task *params)
+{
+	runner->period = params->period;
+	runner->relative_deadline = params->relative_deadline ?
+		params->relative_deadline : params->period;
+	runner->exec_cost = params->exec_cost;
+}
+
+/* the task passed through background mode, which restarted its releases */
+static void restart_releases(struct job_runner *runner)
+{
+	runner->started = 0;
+	runner->first_release = 0;
+}
+
+/* Fix the job whose release first_release refers to. Unless the caller
+ * knows that release, estimate it: the current job was released at the
+ * latest now, and just before if the task only now (re-)entered real-time
+ * mode. Releases of later jobs follow from their job numbers. */
+static int anchor_releases(struct job_runner *runner)
+{
+	if (get_job_no(&runner->first_job_no) != 0)
+		return -1;
+	runner->release_estimated = !runner->first_release;
+	if (runner->release_estimated)
+		runner->first_release = monotonic_ns();
+	runner->started = 1;
+	return 0;
+}
+
+int init_job_runner(struct job_runner *runner, job_fn_t job, void *arg)
+{
+	struct rt_task params;
+
+	memset(runner, 0, sizeof(*runner));
+	if (get_rt_task_param(gettid(), &params) != 0)
+		return -1;
+
+	runner->job  = job;
+	runner->arg  = arg;
+	runner->stats = &runner->local_stats;
+	set_timing_params(runner, &params);
+	return 0;
+}
+
+/* called by the owning task only, so no atomics needed */
+static void account_job(struct job_stats *stats, const struct job_timing *t,
+			int missed, int overran, unsigned int skipped)
+{
+	lt_t response = t->completion - t->release;
+	int64_t lateness = (int64_t) (t->completion - t->deadline);
+
+	seqcount_write_begin(&stats->seq);
+	if (!stats->jobs || lateness > stats->max_lateness)
+		stats->max_lateness = lateness;
+	stats->jobs++;
+	stats->last_job_no = t->job_no;
+	if (missed)
+		stats->misses++;
+	if (overran)
+		stats->overruns++;
+	stats->skipped += skipped;
+	stats->total_response += response;
+	if (response > stats->max_response)
+		stats->max_response = response;
+	stats->total_exec += t->exec_time;
+	if (t->exec_time > stats->max_exec)
+		stats->max_exec = t->exec_time;
+	seqcount_write_end(&stats->seq);
+}
+
+static void update_budget(struct job_runner *runner, lt_t exec_time,
+			  int last_job)
+{
+	const struct exec_budget_policy *policy = runner->budget_policy;
+	lt_t budget;
+
+	exec_estimator_add(runner->estimator, exec_time);
+	if (last_job || !policy || !(policy->flags & EXEC_BUDGET_APPLY))
+		return;
+
+	budget = recommend_exec_cost(runner->estimator, policy,
+				     runner->exec_cost);
+	/* LITMUS^RT rejects budgets that exceed the relative deadline */
+	if (budget > runner->relative_deadline)
+		budget = runner->relative_deadline;
+	if (budget != runner->exec_cost && apply_exec_cost(budget) == 0) {
+		runner->exec_cost = budget;
+		restart_releases(runner);
+	}
+}
+
+static int apply_mode_change(struct job_runner *runner)
+{
+	struct rt_task params;
+
+	if (mode_change_poll(runner->mode_change, &params) != 1)
+		return 0;
+	set_timing_params(runner, &params);
+	restart_releases(runner);
+	return 1;
+}
+
+/* number of jobs to skip after a late job */
+static unsigned int jobs_to_skip(struct job_runner *runner,
+				 const struct job_timing *t, int missed)
+{
+	struct mk_firm *mk = runner->mk_firm;
+	unsigned int backlog, skip;
+
+	mk_firm_record(mk, !missed);
+	if (!missed || t->completion - t->deadline <= mk->threshold)
+		return 0;
+
+	/* jobs after this one that have been released already */
+	backlog = (t->completion - t->release) / runner->period;
+	skip = mk_firm_skippable(mk, backlog);
+	mk_firm_skip(mk, skip);
+	return skip;
+}
+
+int run_jobs(struct job_runner *runner)
+{
+	struct job_timing t;
+	struct job_state js;
+	lt_t exec_start;
+	int done, missed, overran, err;
+	unsigned int skip = 0;
+
+	do {
+		if (unlikely(!runner->started) && anchor_releases(runner) != 0)
+			return -1;
+		if (skip)
+			/* let the kernel complete the skipped jobs */
+			err = wait_for_job_release(t.job_no + 1 + skip);
+		else
+			err = sleep_next_period();
+		if (err != 0 || get_job_state(&js) != 0)
+			return -1;
+		t.job_no = js.job_no;
+		t.start = monotonic_ns();
+		exec_start = thread_cputime_ns();
+
+		done = runner->job(runner->arg);
+
+		t.exec_time  = thread_cputime_ns() - exec_start;
+		t.completion = monotonic_ns();
+		if (js.release) {
+			/* published by the kernel */
+			t.release  = js.release;
+			t.deadline = js.deadline;
+		} else {
+			t.release  = runner->first_release + (lt_t)
+				(t.job_no - runner->first_job_no) * runner->period;
+			if (runner->release_estimated && t.start < t.release) {
+				/* no job starts before its release, so the
+				 * estimate was too late */
+				runner->first_release -= t.release - t.start;
+				t.release = t.start;
+			}
+			t.deadline = t.release + runner->relative_deadline;
+		}
+
+		missed  = t.completion > t.deadline;
+		overran = runner->exec_cost && t.exec_time > runner->exec_cost;
+		skip    = runner->mk_firm && !done ?
+			jobs_to_skip(runner, &t, missed) : 0;
+		account_job(runner->stats, &t, missed, overran, skip);
+
+		if (missed && runner->on_miss)
+			runner->on_miss(&t, runner->arg);
+		if (overran && runner->on_overrun)
+			runner->on_overrun(&t, runner->arg);
+
+		if (runner->estimator)
+			update_budget(runner, t.exec_time, done);
+		if (runner->mode_change && !done && apply_mode_change(runner))
+			skip = 0; /* the release sequence restarted */
+	} while (!done);
+
+	return 0;
+}
+
+struct job_stats* map_job_stats(const char* path, int count)
+{
+	if (count <= 0)
+		return NULL;
+	return map_shared_file(path, count * sizeof(struct job_stats));
+}
+
+void read_job_stats(const struct job_stats *stats,
+		    struct job_stats *snapshot)
+{
+	uint64_t seq;
+
+	do {
+		seq = seqcount_read_begin(&stats->seq);
+		snapshot->jobs           = stats->jobs;
+		snapshot->misses         = stats->misses;
+		snapshot->overruns       = stats->overruns;
+		snapshot->skipped        = stats->skipped;
+		snapshot->last_job_no    = stats->last_job_no;
+		snapshot->max_response   = stats->max_response;
+		snapshot->total_response = stats->total_response;
+		snapshot->max_lateness   = stats->max_lateness;
+		snapshot->max_exec       = stats->max_exec;
+		snapshot->total_exec     = stats->total_exec;
+	} while (seqcount_read_retry(&stats->seq, seq));
+	snapshot->seq = seq;
+}
@@ -1,5 +1,6 @@
 #include <sys/mman.h>
 #include <sys/fcntl.h> /* for O_RDWR */
+#include <sys/stat.h>
 #include <sys/unistd.h>
 #include <sched.h> /* for sched_yield() */
 
@@ -37,6 +38,28 @@ static int map_file(const char* filename, void **addr, size_t size)
 	return error;
 }
 
+void* map_shared_file(const char* filename, size_t size)
+{
+	int fd;
+	struct stat st;
+	void *addr = NULL;
+
+	fd = open(filename, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (fd < 0)
+		return NULL;
+
+	/* never shrink a region that somebody else may have sized */
+	if (fstat(fd, &st) == 0 &&
+	    (st.st_size >= size || ftruncate(fd, size) == 0)) {
+		addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+			    fd, 0);
+		if (addr == MAP_FAILED)
+			addr = NULL;
+	}
+	close(fd);
+	return addr;
+}
+
 ssize_t read_file(const char* fname, void* buf, size_t maxlen)
 {
 	int fd;
@@ -82,6 +105,10 @@ int get_nr_ts_release_waiters(void)
 /* thread-local pointer to control page */
 static __thread struct control_page *ctrl_page;
 
+/* thread-local NP section accounting, NULL unless enabled */
+static __thread struct np_stats *np_stats;
+static __thread cycles_t np_start;
+
 int init_kernel_iface(void)
 {
 	int err = 0;
@@ -114,23 +141,74 @@ int init_kernel_iface(void)
 	return err;
 }
 
+struct np_stats* map_np_stats(const char* path, int count)
+{
+	if (count <= 0)
+		return NULL;
+	return map_shared_file(path, count * sizeof(struct np_stats));
+}
+
+void enable_np_stats(struct np_stats *stats)
+{
+	/* when enabled inside a section, account from now on */
+	if (stats && ctrl_page && ctrl_page->sched.np.flag)
+		np_start = get_cycles();
+	np_stats = stats;
+}
+
+void read_np_stats(const struct np_stats *stats, struct np_stats *snapshot)
+{
+	uint64_t seq;
+
+	do {
+		seq = seqcount_read_begin(&stats->seq);
+		snapshot->sections            = stats->sections;
+		snapshot->max_cycles          = stats->max_cycles;
+		snapshot->total_cycles        = stats->total_cycles;
+		snapshot->delayed_preemptions = stats->delayed_preemptions;
+	} while (seqcount_read_retry(&stats->seq, seq));
+	snapshot->seq = seq;
+}
+
+/* called by the owning thread only, so no atomics needed */
+static void account_np_section(int yielded)
+{
+	cycles_t len = get_cycles() - np_start;
+
+	seqcount_write_begin(&np_stats->seq);
+	np_stats->sections++;
+	np_stats->total_cycles += len;
+	if (len > np_stats->max_cycles)
+		np_stats->max_cycles = len;
+	if (yielded)
+		np_stats->delayed_preemptions++;
+	seqcount_write_end(&np_stats->seq);
+}
+
 void enter_np(void)
 {
-	if (likely(ctrl_page != NULL) || init_kernel_iface() == 0)
+	if (likely(ctrl_page != NULL) || init_kernel_iface() == 0) {
+		if (unlikely(np_stats != NULL) && !ctrl_page->sched.np.flag)
+			np_start = get_cycles();
 		ctrl_page->sched.np.flag++;
-	else
+	} else
 		fprintf(stderr, "enter_np: control page not mapped!\n");
 }
 
 
 void exit_np(void)
 {
+	int yield;
+
 	if (likely(ctrl_page != NULL) &&
 	    ctrl_page->sched.np.flag &&
 	    !(--ctrl_page->sched.np.flag)) {
 		/* became preemptive, let's check for delayed preemptions */
 		__sync_synchronize();
-		if (ctrl_page->sched.np.preempt)
+		yield = ctrl_page->sched.np.preempt;
+		if (unlikely(np_stats != NULL))
+			account_np_section(yield);
+		if (yield)
 			sched_yield();
 	}
 }
@@ -153,3 +231,50 @@ struct control_page* get_ctrl_page(void)
 		return NULL;
 }
 
+#ifdef LITMUS_CP_JOB_STATE
+
+int get_job_state(struct job_state *state)
+{
+	struct control_page *cp = get_ctrl_page();
+	uint64_t index;
+
+	if (unlikely(!cp))
+		return -1;
+
+	/* The kernel updates these fields at job boundaries, writing the job
+	 * index last, and only while this thread is not executing in user
+	 * space, i.e., never concurrently with the reads below. If it does so
+	 * while the thread is preempted in the middle of them, the job index
+	 * differs afterwards, so it serves as the sequence number. (On its
+	 * own, it could not detect a writer running in parallel.) */
+	do {
+		index = *(volatile uint64_t*) &cp->job_index;
+		__sync_synchronize();
+		state->release  = *(volatile lt_t*) &cp->release;
+		state->deadline = *(volatile lt_t*) &cp->deadline;
+		__sync_synchronize();
+	} while (index != *(volatile uint64_t*) &cp->job_index);
+	state->job_no = (unsigned int) index;
+	return 0;
+}
+
+int job_state_in_ctrl_page(void)
+{
+	return 1;
+}
+
+#else
+
+int get_job_state(struct job_state *state)
+{
+	state->release  = 0;
+	state->deadline = 0;
+	return get_job_no(&state->job_no);
+}
+
+int job_state_in_ctrl_page(void)
+{
+	return 0;
+}
+
+#endif
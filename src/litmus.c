@@ -171,10 +171,17 @@ int init_kernel_iface(void);
 
 int init_litmus(void)
 {
-	int ret, ret2;
+	return init_litmus_flags(0);
+}
+
+int init_litmus_flags(int flags)
+{
+	int ret = 0, ret2;
 
-	ret = mlockall(MCL_CURRENT | MCL_FUTURE);
-	check("mlockall()");
+	if (!(flags & LITMUS_NO_MLOCKALL)) {
+		ret = mlockall(MCL_CURRENT | MCL_FUTURE);
+		check("mlockall()");
+	}
 	ret2 = init_rt_thread();
 	return (ret == 0) && (ret2 == 0) ? 0 : -1;
 }
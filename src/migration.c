@@ -3,10 +3,13 @@
 #include <string.h>
 #include <sched.h> /* for cpu sets */
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <dirent.h>
+#include <pthread.h>
 
-#include "migration.h"
-
-extern ssize_t read_file(const char* fname, void* buf, size_t maxlen);
+#include "litmus.h"
+#include "internal.h"
 
 int release_master()
 {
@@ -254,3 +257,190 @@ int partition_to_cpu(int partition)
 {
 	return domain_to_first_cpu(partition);
 }
+
+
+/* housekeeping threads */
+
+int housekeeping_cpus(const int *rt_domains, int ndomains,
+		      unsigned long long int* mask)
+{
+	unsigned long long rt = 0, cpus, online;
+	char buf[1024];
+	ssize_t len;
+	int i, n = num_online_cpus();
+
+	if (n <= 0 || n > sizeof(*mask)*8)
+		return -1;
+	/* CPU IDs may have gaps, e.g., if CPUs were taken offline */
+	len = read_file("/sys/devices/system/cpu/online", buf, sizeof(buf) - 1);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+	online = parse_cpu_list(buf);
+	for (i = 0; i < ndomains; i++) {
+		if (domain_to_cpus(rt_domains[i], &cpus) != 0)
+			return -1;
+		rt |= cpus;
+	}
+	*mask = online & ~rt;
+	return *mask ? 0 : -1;
+}
+
+static int is_rt_thread(pid_t tid)
+{
+	struct rt_task param;
+
+	if (sched_getscheduler(tid) == SCHED_LITMUS)
+		return 1;
+	/* parameters set, but not yet in real-time mode */
+	return get_rt_task_param(tid, &param) == 0 && param.exec_cost;
+}
+
+/* A thread that may run only on CPUs outside the housekeeping set has been
+ * migrated to a real-time domain, e.g., by admit_thread() in rt_thread.c,
+ * and is about to be given real-time parameters. */
+static int in_rt_domain(pid_t tid, const cpu_set_t *housekeeping,
+			cpu_set_t *cur, size_t sz)
+{
+	if (sched_getaffinity(tid, sz, cur) != 0)
+		return 0;
+	CPU_AND_S(sz, cur, cur, housekeeping);
+	return CPU_COUNT_S(sz, cur) == 0;
+}
+
+int migrate_housekeeping_threads(unsigned long long int mask)
+{
+	cpu_set_t *set, *cur;
+	size_t sz;
+	struct dirent *d;
+	DIR *dir;
+	pid_t tid;
+	int i, moved = 0;
+
+	if (!mask)
+		return -1;
+
+	set = CPU_ALLOC(sizeof(mask)*8);
+	cur = CPU_ALLOC(sizeof(mask)*8);
+	sz = CPU_ALLOC_SIZE(sizeof(mask)*8);
+	if (!set || !cur) {
+		CPU_FREE(set);
+		CPU_FREE(cur);
+		return -1;
+	}
+	CPU_ZERO_S(sz, set);
+	for (i = 0; i < sizeof(mask)*8; i++)
+		if (mask & (1ULL << i))
+			CPU_SET_S(i, sz, set);
+
+	dir = opendir("/proc/self/task");
+	if (!dir) {
+		CPU_FREE(set);
+		CPU_FREE(cur);
+		return -1;
+	}
+	while ((d = readdir(dir)) != NULL) {
+		tid = atoi(d->d_name);
+		if (tid <= 0 || is_rt_thread(tid) ||
+		    in_rt_domain(tid, set, cur, sz))
+			continue;
+		if (sched_setaffinity(tid, sz, set) == 0)
+			moved++;
+		else if (errno != ESRCH) {
+			moved = -1;
+			break;
+		}
+	}
+	closedir(dir);
+	CPU_FREE(set);
+	CPU_FREE(cur);
+	return moved;
+}
+
+static struct {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	unsigned long long mask;
+	struct timespec interval;
+	int running;
+	int stop;
+} watcher = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static void* housekeeping_watcher(void *unused)
+{
+	struct timespec next;
+
+	pthread_mutex_lock(&watcher.lock);
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	while (!watcher.stop) {
+		pthread_mutex_unlock(&watcher.lock);
+		migrate_housekeeping_threads(watcher.mask);
+		pthread_mutex_lock(&watcher.lock);
+
+		next.tv_sec  += watcher.interval.tv_sec;
+		next.tv_nsec += watcher.interval.tv_nsec;
+		if (next.tv_nsec >= 1000000000L) {
+			next.tv_sec++;
+			next.tv_nsec -= 1000000000L;
+		}
+		while (!watcher.stop &&
+		       pthread_cond_timedwait(&watcher.wake, &watcher.lock,
+					      &next) == 0)
+			; /* woken up early, but not asked to stop */
+	}
+	pthread_mutex_unlock(&watcher.lock);
+	return NULL;
+}
+
+int start_housekeeping_watcher(unsigned long long int mask,
+			       unsigned long long interval_ns)
+{
+	pthread_condattr_t attr;
+	int ret = -1;
+
+	if (!interval_ns || migrate_housekeeping_threads(mask) < 0)
+		return -1;
+
+	pthread_mutex_lock(&watcher.lock);
+	if (!watcher.running) {
+		watcher.mask = mask;
+		watcher.interval.tv_sec  = interval_ns / 1000000000ULL;
+		watcher.interval.tv_nsec = interval_ns % 1000000000ULL;
+		watcher.stop = 0;
+		/* deadlines must not move with the wall clock */
+		pthread_condattr_init(&attr);
+		pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+		pthread_cond_init(&watcher.wake, &attr);
+		pthread_condattr_destroy(&attr);
+		if (pthread_create(&watcher.thread, NULL,
+				   housekeeping_watcher, NULL) == 0) {
+			watcher.running = 1;
+			ret = 0;
+		} else
+			pthread_cond_destroy(&watcher.wake);
+	}
+	pthread_mutex_unlock(&watcher.lock);
+	return ret;
+}
+
+void stop_housekeeping_watcher(void)
+{
+	pthread_mutex_lock(&watcher.lock);
+	if (!watcher.running) {
+		pthread_mutex_unlock(&watcher.lock);
+		return;
+	}
+	watcher.stop = 1;
+	pthread_cond_signal(&watcher.wake);
+	pthread_mutex_unlock(&watcher.lock);
+
+	pthread_join(watcher.thread, NULL);
+
+	pthread_mutex_lock(&watcher.lock);
+	pthread_cond_destroy(&watcher.wake);
+	watcher.running = 0;
+	pthread_mutex_unlock(&watcher.lock);
+}
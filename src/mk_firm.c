@@ -0,0 +1,62 @@
+#include <stdint.h>
+#include <errno.h>
+
+#include "litmus.h"
+#include "mk_firm.h"
+
+static uint64_t window_mask(const struct mk_firm *mk)
+{
+	return mk->k == 64 ? ~0ULL : (1ULL << mk->k) - 1;
+}
+
+/* met deadlines in the window after shifting in n misses */
+static unsigned int met_after_misses(const struct mk_firm *mk, unsigned int n)
+{
+	if (n >= 64)
+		return 0;
+	return __builtin_popcountll((mk->history << n) & window_mask(mk));
+}
+
+int init_mk_firm(struct mk_firm *mk, unsigned int m, unsigned int k,
+		 lt_t threshold)
+{
+	if (!m || m > k || k > MK_FIRM_MAX_K) {
+		errno = EINVAL;
+		return -1;
+	}
+	mk->m = m;
+	mk->k = k;
+	mk->threshold  = threshold;
+	mk->history    = window_mask(mk);
+	mk->skipped    = 0;
+	mk->violations = 0;
+	return 0;
+}
+
+void mk_firm_record(struct mk_firm *mk, int met)
+{
+	mk->history = ((mk->history << 1) | (met ? 1 : 0)) & window_mask(mk);
+	if (met_after_misses(mk, 0) < mk->m)
+		mk->violations++;
+}
+
+unsigned int mk_firm_skippable(const struct mk_firm *mk,
+			       unsigned int backlog)
+{
+	unsigned int skip;
+
+	/* Each skipped job shifts a miss into the window, so the number of
+	 * met deadlines per window can only decrease with every skip. */
+	for (skip = 0; skip < backlog; skip++)
+		if (met_after_misses(mk, skip + 1) < mk->m)
+			break;
+	return skip;
+}
+
+void mk_firm_skip(struct mk_firm *mk, unsigned int count)
+{
+	while (count--) {
+		mk_firm_record(mk, 0);
+		mk->skipped++;
+	}
+}
@@ -0,0 +1,144 @@
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "mode_change.h"
+
+/* poll interval of mode_change_wait() */
+#define MODE_CHANGE_POLL_NS ms2ns(1)
+
+struct mode_change_region* map_mode_change(const char *path, int ntasks)
+{
+	struct mode_change_region *region;
+
+	if (ntasks <= 0)
+		return NULL;
+	region = map_shared_file(path, sizeof(*region) +
+				 ntasks * sizeof(struct mode_change_slot));
+	if (region && !region->ntasks)
+		region->ntasks = ntasks;
+	return region;
+}
+
+int mode_change_set(struct mode_change_region *region, int slot,
+		    const struct rt_task *params, int domain)
+{
+	struct mode_change_slot *s;
+
+	if (slot < 0 || slot >= region->ntasks) {
+		errno = EINVAL;
+		return -1;
+	}
+	s = region->slots + slot;
+	seqcount_write_begin(&s->seq);
+	s->params   = *params;
+	s->domain   = domain;
+	s->assigned = region->generation + 1;
+	seqcount_write_end(&s->seq);
+	return 0;
+}
+
+uint32_t mode_change_commit(struct mode_change_region *region)
+{
+	/* publish the slots before the new generation */
+	__sync_synchronize();
+	return __sync_add_and_fetch(&region->generation, 1);
+}
+
+int mode_change_pending(const struct mode_change_region *region,
+			uint32_t generation)
+{
+	int i, pending = 0;
+
+	for (i = 0; i < region->ntasks; i++)
+		if (region->slots[i].assigned &&
+		    (int32_t) (region->slots[i].acked - generation) < 0)
+			pending++;
+	return pending;
+}
+
+int mode_change_wait(const struct mode_change_region *region,
+		     uint32_t generation, lt_t timeout)
+{
+	lt_t now = monotonic_ns();
+	lt_t give_up = now + timeout;
+	int i;
+
+	while (mode_change_pending(region, generation)) {
+		if (timeout && now >= give_up) {
+			errno = ETIMEDOUT;
+			return -1;
+		}
+		lt_sleep_until(now + MODE_CHANGE_POLL_NS);
+		now = monotonic_ns();
+	}
+
+	for (i = 0; i < region->ntasks; i++)
+		if (region->slots[i].assigned && region->slots[i].error) {
+			errno = EIO;
+			return -1;
+		}
+	return 0;
+}
+
+int mode_change_attach(struct mode_change_task *task,
+		       struct mode_change_region *region, int slot)
+{
+	if (slot < 0 || slot >= region->ntasks) {
+		errno = EINVAL;
+		return -1;
+	}
+	task->region = region;
+	task->slot   = slot;
+	task->seen   = region->generation;
+	region->slots[slot].acked = task->seen;
+	return 0;
+}
+
+int mode_change_poll(struct mode_change_task *task, struct rt_task *params)
+{
+	struct mode_change_slot *slot = task->region->slots + task->slot;
+	struct rt_task new_params;
+	uint32_t generation = task->region->generation;
+	uint32_t assigned;
+	uint64_t seq;
+	int domain, ret = 0;
+
+	if (likely(generation == task->seen))
+		return 0;
+
+	/* The coordinator runs at a lower priority than we do, possibly on the
+	 * same CPU, so spinning until it finishes an update could take forever.
+	 * Try again at the next job boundary instead. */
+	if (!seqcount_read_try(&slot->seq, &seq))
+		return 0;
+	assigned   = slot->assigned;
+	new_params = slot->params;
+	domain     = slot->domain;
+	if (seqcount_read_retry(&slot->seq, seq))
+		return 0;
+	/* reassigned for a generation that is not committed yet; the
+	 * parameters of the committed one are gone, so wait for the newer */
+	if ((int32_t) (assigned - generation) > 0)
+		return 0;
+
+	if ((int32_t) (assigned - task->seen) > 0) {
+		/* our parameters changed since the last generation we handled */
+		if (change_rt_task_param(&new_params, domain) == 0) {
+			slot->error = 0;
+			if (params)
+				*params = new_params;
+			ret = 1;
+		} else {
+			slot->error = errno ? errno : EINVAL;
+			ret = -1;
+		}
+	}
+
+	task->seen = generation;
+	__sync_synchronize();
+	slot->acked = generation;
+	return ret;
+}
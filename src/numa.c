@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "arena.h"
+#include "numa.h"
+
+#define DEFAULT_SYS_ROOT "/sys"
+#define DEFAULT_NUMA_MAPS "/proc/self/numa_maps"
+
+/* pages queried per move_pages() call */
+#define PAGE_BATCH 256
+
+/* The kernel ignores the last bit of a node mask of maxnode bits. */
+#define MAXNODE (NUMA_MAX_NODES + 1)
+
+int cpus_to_node(const char *sys_root, unsigned long long cpus)
+{
+	const char *root = sys_root ? sys_root : DEFAULT_SYS_ROOT;
+	char fname[4096], buf[1024];
+	ssize_t len;
+	int node, missing = 0;
+
+	if (!cpus)
+		return -1;
+	/* node IDs may have gaps */
+	for (node = 0; node < NUMA_MAX_NODES && missing < NUMA_MAX_NODES;
+	     node++) {
+		snprintf(fname, sizeof(fname),
+			 "%s/devices/system/node/node%d/cpulist", root, node);
+		len = read_file(fname, buf, sizeof(buf) - 1);
+		if (len <= 0) {
+			missing++;
+			continue;
+		}
+		buf[len] = '\0';
+		if (!(cpus & ~parse_cpu_list(buf)))
+			return node;
+	}
+	return -1;
+}
+
+int domain_to_node(int domain)
+{
+	unsigned long long cpus;
+
+	if (domain_to_cpus(domain, &cpus) != 0)
+		return -1;
+	return cpus_to_node(NULL, cpus);
+}
+
+static void count_page(struct numa_page_stats *stats, int status, int node)
+{
+	stats->pages++;
+	if (status == node)
+		stats->local++;
+	else if (status >= 0)
+		stats->remote++;
+	else
+		stats->absent++;
+}
+
+int count_node_pages(void *addr, size_t len, int node,
+		     struct numa_page_stats *stats)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	char *start = (char*) ((unsigned long) addr & ~(page_size - 1));
+	char *end = (char*) addr + len;
+	void *pages[PAGE_BATCH];
+	int status[PAGE_BATCH];
+	int i, n;
+
+	memset(stats, 0, sizeof(*stats));
+	while (start < end) {
+		for (n = 0; n < PAGE_BATCH && start < end; n++) {
+			pages[n] = start;
+			start += page_size;
+		}
+		/* without target nodes, move_pages() only reports */
+		if (syscall(SYS_move_pages, 0, n, pages, NULL, status, 0) != 0)
+			return -1;
+		for (i = 0; i < n; i++)
+			count_page(stats, status[i], node);
+	}
+	return 0;
+}
+
+int count_process_pages(const char *numa_maps, int node,
+			struct numa_page_stats *stats)
+{
+	char *line = NULL, *pos, *end;
+	size_t len = 0;
+	long id, pages;
+	FILE *f;
+
+	f = fopen(numa_maps ? numa_maps : DEFAULT_NUMA_MAPS, "r");
+	if (!f)
+		return -1;
+	memset(stats, 0, sizeof(*stats));
+
+	/* each mapping lists its pages per node as N<node>=<pages> */
+	while (getline(&line, &len, f) >= 0) {
+		for (pos = strstr(line, " N"); pos; pos = strstr(pos, " N")) {
+			pos += 2;
+			id = strtol(pos, &end, 10);
+			if (end == pos || *end != '=')
+				continue;
+			pos = end + 1;
+			pages = strtol(pos, &end, 10);
+			if (end == pos)
+				continue;
+			stats->pages += pages;
+			if (id == node)
+				stats->local += pages;
+			else
+				stats->remote += pages;
+		}
+	}
+	free(line);
+	fclose(f);
+	return 0;
+}
+
+static int node_mask(int node, unsigned long *mask)
+{
+	if (node < 0 || node >= NUMA_MAX_NODES) {
+		errno = EINVAL;
+		return -1;
+	}
+	memset(mask, 0, NUMA_MAX_NODES / 8);
+	mask[node / (8 * sizeof(*mask))] = 1UL << (node % (8 * sizeof(*mask)));
+	return 0;
+}
+
+static int policy_of(int flags)
+{
+	return flags & NUMA_MEM_PREFER ? MPOL_PREFERRED : MPOL_BIND;
+}
+
+int bind_memory_to_node(void *addr, size_t len, int node, int flags)
+{
+	unsigned long mask[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	long page_size = sysconf(_SC_PAGESIZE);
+	unsigned long start = (unsigned long) addr & ~(page_size - 1);
+
+	if (node_mask(node, mask) != 0)
+		return -1;
+	len += (unsigned long) addr - start;
+	return syscall(SYS_mbind, start, len, policy_of(flags), mask, MAXNODE,
+		       flags & NUMA_MEM_MIGRATE ? MPOL_MF_MOVE : 0) == 0 ? 0 : -1;
+}
+
+int rt_arena_to_node(struct rt_arena *arena, int node, int flags)
+{
+	if (!arena->base) {
+		errno = EINVAL;
+		return -1;
+	}
+	return bind_memory_to_node(arena->base, arena->size, node, flags);
+}
+
+int migrate_memory_to_node(int node, int flags)
+{
+	unsigned long target[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	unsigned long others[NUMA_MAX_NODES / (8 * sizeof(unsigned long))];
+	char fname[] = DEFAULT_SYS_ROOT "/devices/system/node/online";
+	char buf[1024];
+	unsigned long long online;
+	ssize_t len;
+	size_t i;
+
+	if (node_mask(node, target) != 0)
+		return -1;
+	if (syscall(SYS_set_mempolicy, policy_of(flags), target, MAXNODE) != 0)
+		return -1;
+	if (!(flags & NUMA_MEM_MIGRATE))
+		return 0;
+
+	/* migrate_pages() rejects nodes that do not exist */
+	len = read_file(fname, buf, sizeof(buf) - 1);
+	if (len <= 0)
+		return -1;
+	buf[len] = '\0';
+	online = parse_cpu_list(buf) & ~(1ULL << node);
+	if (!online)
+		return 0;
+	for (i = 0; i < sizeof(others) / sizeof(*others); i++)
+		others[i] = online >> (i * 8 * sizeof(*others));
+
+	/* returns the number of pages that could not be moved */
+	return syscall(SYS_migrate_pages, 0, MAXNODE, others, target) < 0 ?
+		-1 : 0;
+}
+
+int be_migrate_to_domain_numa(int domain, int flags)
+{
+	int node;
+
+	if (be_migrate_to_domain(domain) != 0)
+		return -1;
+	node = domain_to_node(domain);
+	if (node < 0) {
+		errno = EXDEV;
+		return -1;
+	}
+	return migrate_memory_to_node(node, flags) == 0 ? node : -1;
+}
@@ -0,0 +1,402 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "litmus.h"
+#include "rt_graph.h"
+
+struct rt_graph_thread {
+	struct rt_graph *g;
+	int node;
+};
+
+/***** histograms *****/
+
+void rt_hist_add(struct rt_hist *h, lt_t value)
+{
+	int bucket = value ? 64 - __builtin_clzll(value) : 0;
+	uint64_t max;
+
+	if (bucket >= RT_HIST_BUCKETS)
+		bucket = RT_HIST_BUCKETS - 1;
+	__sync_fetch_and_add(&h->buckets[bucket], 1);
+	__sync_fetch_and_add(&h->sum, value);
+	__sync_fetch_and_add(&h->count, 1);
+	do {
+		max = h->max;
+	} while (value > max && !__sync_bool_compare_and_swap(&h->max, max, value));
+}
+
+lt_t rt_hist_quantile(const struct rt_hist *h, double q)
+{
+	uint64_t target, seen = 0;
+	lt_t bound;
+	int i;
+
+	if (!h->count)
+		return 0;
+	target = (uint64_t) (q * h->count);
+	if (target < q * h->count || !target)
+		target++;
+
+	for (i = 0; i < RT_HIST_BUCKETS - 1; i++) {
+		seen += h->buckets[i];
+		if (seen >= target)
+			break;
+	}
+	bound = i ? (1ULL << i) - 1 : 0;
+	return bound < h->max ? bound : h->max;
+}
+
+/***** graph construction *****/
+
+void rt_graph_init(struct rt_graph *g)
+{
+	memset(g, 0, sizeof(*g));
+}
+
+int rt_graph_add_node(struct rt_graph *g, const char *name,
+		      const struct rt_task *params, int domain,
+		      rt_graph_fn_t fn, void *arg)
+{
+	struct rt_graph_node *n;
+
+	if (g->nnodes == RT_GRAPH_MAX_NODES) {
+		errno = ENOSPC;
+		return -1;
+	}
+	n = g->nodes + g->nnodes;
+	n->name   = name;
+	n->params = *params;
+	n->domain = domain;
+	n->fn     = fn;
+	n->arg    = arg;
+	return g->nnodes++;
+}
+
+int rt_graph_add_edge(struct rt_graph *g, int from, int to,
+		      unsigned int capacity)
+{
+	struct rt_graph_edge *e;
+	unsigned int size = 1;
+
+	if (from < 0 || from >= g->nnodes || to < 0 || to >= g->nnodes ||
+	    from == to || !capacity) {
+		errno = EINVAL;
+		return -1;
+	}
+	if (g->nedges == RT_GRAPH_MAX_EDGES) {
+		errno = ENOSPC;
+		return -1;
+	}
+	while (size < capacity)
+		size <<= 1;
+
+	e = g->edges + g->nedges;
+	e->from     = from;
+	e->to       = to;
+	e->capacity = size;
+	g->nodes[from].out[g->nodes[from].nout++] = g->nedges;
+	g->nodes[to].in[g->nodes[to].nin++] = g->nedges;
+	return g->nedges++;
+}
+
+/* Kahn's algorithm; returns -1 if the graph has a cycle */
+static int topological_order(const struct rt_graph *g, int *order)
+{
+	int indegree[RT_GRAPH_MAX_NODES];
+	int i, j, n = 0, done = 0;
+	const struct rt_graph_node *node;
+
+	for (i = 0; i < g->nnodes; i++) {
+		indegree[i] = g->nodes[i].nin;
+		if (!indegree[i])
+			order[n++] = i;
+	}
+	while (done < n) {
+		node = g->nodes + order[done++];
+		for (j = 0; j < node->nout; j++)
+			if (!--indegree[g->edges[node->out[j]].to])
+				order[n++] = g->edges[node->out[j]].to;
+	}
+	return n == g->nnodes ? 0 : -1;
+}
+
+/***** edges *****/
+
+static void futex_wait(volatile int *addr, int val)
+{
+	syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void futex_wake(volatile int *addr)
+{
+	syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+static void wake_node(struct rt_graph_node *n)
+{
+	__sync_fetch_and_add(&n->wake, 1);
+	futex_wake(&n->wake);
+}
+
+/* called by the producer only */
+static void edge_push(struct rt_graph *g, struct rt_graph_edge *e,
+		      const struct rt_graph_token *tok)
+{
+	unsigned int tail = e->tail;
+
+	if (tail - e->head == e->capacity) {
+		/* never block a real-time producer */
+		e->overflows++;
+		return;
+	}
+	e->ring[tail & (e->capacity - 1)] = *tok;
+	__sync_synchronize();
+	e->tail = tail + 1;
+	wake_node(g->nodes + e->to);
+}
+
+/* called by the consumer only, and only if the edge is not empty */
+static void edge_pop(struct rt_graph_edge *e, struct rt_graph_token *tok)
+{
+	unsigned int head = e->head;
+
+	__sync_synchronize();
+	*tok = e->ring[head & (e->capacity - 1)];
+	__sync_synchronize();
+	e->head = head + 1;
+}
+
+static int inputs_ready(const struct rt_graph *g,
+			const struct rt_graph_node *n)
+{
+	int i;
+
+	for (i = 0; i < n->nin; i++)
+		if (g->edges[n->in[i]].head == g->edges[n->in[i]].tail)
+			return 0;
+	return 1;
+}
+
+/* suspend until every input holds a token; -1 if the graph stops */
+static int wait_for_inputs(struct rt_graph *g, struct rt_graph_node *n)
+{
+	int seq;
+
+	for (;;) {
+		seq = n->wake;
+		__sync_synchronize();
+		if (g->stop)
+			return -1;
+		if (inputs_ready(g, n))
+			return 0;
+		futex_wait(&n->wake, seq);
+	}
+}
+
+/***** execution *****/
+
+static void record_path(struct rt_graph *g, uint64_t path, lt_t latency)
+{
+	int i;
+
+	for (i = 0; i < RT_GRAPH_MAX_PATHS; i++) {
+		if (g->paths[i].nodes == path ||
+		    (!g->paths[i].nodes &&
+		     (__sync_bool_compare_and_swap(&g->paths[i].nodes, 0, path) ||
+		      g->paths[i].nodes == path))) {
+			rt_hist_add(&g->paths[i].latency, latency);
+			return;
+		}
+	}
+	__sync_fetch_and_add(&g->untracked, 1);
+}
+
+static void* node_main(void *_ctx)
+{
+	struct rt_graph_thread *ctx = _ctx;
+	struct rt_graph *g = ctx->g;
+	struct rt_graph_node *n = g->nodes + ctx->node;
+	struct rt_graph_token tok;
+	uint64_t in[RT_GRAPH_MAX_EDGES];
+	lt_t now, origin;
+	uint64_t path, out;
+	int i, stop;
+
+	/* the first job starts at the synchronous release */
+	while (!g->stop) {
+		if (n->nin && wait_for_inputs(g, n) != 0)
+			break;
+
+		now = monotonic_ns();
+		origin = now;
+		path = 0;
+		for (i = 0; i < n->nin; i++) {
+			edge_pop(g->edges + n->in[i], &tok);
+			rt_hist_add(&g->edges[n->in[i]].delay, now - tok.enqueued);
+			in[i] = tok.value;
+			/* the oldest input determines the end-to-end latency */
+			if (!i || tok.origin < origin) {
+				origin = tok.origin;
+				path = tok.path;
+			}
+		}
+		path |= 1ULL << ctx->node;
+
+		out = 0;
+		stop = n->fn(ctx->node, n->nin ? in : NULL, n->nin, &out, n->arg);
+		n->jobs++;
+
+		tok.value    = out;
+		tok.origin   = origin;
+		tok.enqueued = monotonic_ns();
+		tok.path     = path;
+		for (i = 0; i < n->nout; i++)
+			edge_push(g, g->edges + n->out[i], &tok);
+		if (!n->nout)
+			record_path(g, path, tok.enqueued - origin);
+
+		if (stop)
+			rt_graph_stop(g);
+		else if (sleep_next_period() != 0)
+			break;
+	}
+
+	task_mode(BACKGROUND_TASK);
+	return NULL;
+}
+
+int rt_graph_start(struct rt_graph *g)
+{
+	struct litmus_thread_spec specs[RT_GRAPH_MAX_NODES];
+	int order[RT_GRAPH_MAX_NODES];
+	int i;
+
+	if (!g->nnodes || topological_order(g, order) != 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	g->ctx = calloc(g->nnodes, sizeof(*g->ctx));
+	if (!g->ctx)
+		return -1;
+	for (i = 0; i < g->nedges; i++) {
+		g->edges[i].ring = calloc(g->edges[i].capacity,
+					  sizeof(struct rt_graph_token));
+		if (!g->edges[i].ring)
+			goto fail;
+	}
+
+	for (i = 0; i < g->nnodes; i++) {
+		g->ctx[i].g    = g;
+		g->ctx[i].node = i;
+		specs[i].params = g->nodes[i].params;
+		specs[i].domain = g->nodes[i].domain;
+		specs[i].stack  = NULL;
+		specs[i].start_routine = node_main;
+		specs[i].arg    = g->ctx + i;
+	}
+
+	if (litmus_threads_create(g->threads, specs, g->nnodes,
+				  LITMUS_THREADS_WAIT_RELEASE, NULL) == 0)
+		return 0;
+
+fail:
+	for (i = 0; i < g->nedges; i++) {
+		free(g->edges[i].ring);
+		g->edges[i].ring = NULL;
+	}
+	free(g->ctx);
+	g->ctx = NULL;
+	return -1;
+}
+
+void rt_graph_stop(struct rt_graph *g)
+{
+	int i;
+
+	g->stop = 1;
+	__sync_synchronize();
+	for (i = 0; i < g->nnodes; i++)
+		wake_node(g->nodes + i);
+}
+
+void rt_graph_join(struct rt_graph *g)
+{
+	int i;
+
+	for (i = 0; i < g->nnodes; i++)
+		pthread_join(g->threads[i], NULL);
+	for (i = 0; i < g->nedges; i++) {
+		free(g->edges[i].ring);
+		g->edges[i].ring = NULL;
+	}
+	free(g->ctx);
+	g->ctx = NULL;
+}
+
+/***** reporting *****/
+
+int rt_graph_critical_path(const struct rt_graph *g)
+{
+	int i, critical = -1;
+
+	for (i = 0; i < RT_GRAPH_MAX_PATHS && g->paths[i].nodes; i++)
+		if (critical < 0 || g->paths[i].latency.max >
+		    g->paths[critical].latency.max)
+			critical = i;
+	return critical;
+}
+
+static void print_hist(FILE *out, const struct rt_hist *h)
+{
+	fprintf(out, " %8llu %12llu %12llu %12llu",
+		(unsigned long long) h->count,
+		(unsigned long long) (h->count ? h->sum / h->count : 0),
+		(unsigned long long) rt_hist_quantile(h, 0.99),
+		(unsigned long long) h->max);
+}
+
+void rt_graph_report(const struct rt_graph *g, FILE *out)
+{
+	int order[RT_GRAPH_MAX_NODES];
+	int i, j, first, critical = rt_graph_critical_path(g);
+	const struct rt_graph_edge *e;
+
+	if (topological_order(g, order) != 0)
+		return;
+
+	fprintf(out, "# end-to-end latency per path [ns]\n");
+	fprintf(out, "# %8s %12s %12s %12s  %s\n",
+		"COUNT", "MEAN", "P99", "MAX", "PATH");
+	for (i = 0; i < RT_GRAPH_MAX_PATHS && g->paths[i].nodes; i++) {
+		print_hist(out, &g->paths[i].latency);
+		fprintf(out, "  ");
+		for (j = 0, first = 1; j < g->nnodes; j++)
+			if (g->paths[i].nodes & (1ULL << order[j])) {
+				fprintf(out, "%s%s", first ? "" : " -> ",
+					g->nodes[order[j]].name);
+				first = 0;
+			}
+		fprintf(out, "%s\n", i == critical ? "  [critical]" : "");
+	}
+	if (g->untracked)
+		fprintf(out, "# %llu tokens on untracked paths\n",
+			(unsigned long long) g->untracked);
+
+	fprintf(out, "# queueing delay per edge [ns]\n");
+	fprintf(out, "# %8s %12s %12s %12s  %s\n",
+		"COUNT", "MEAN", "P99", "MAX", "EDGE (OVERFLOWS)");
+	for (i = 0; i < g->nedges; i++) {
+		e = g->edges + i;
+		print_hist(out, &e->delay);
+		fprintf(out, "  %s -> %s (%llu)\n",
+			g->nodes[e->from].name, g->nodes[e->to].name,
+			(unsigned long long) e->overflows);
+	}
+}
@@ -0,0 +1,269 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "litmus.h"
+#include "rt_thread.h"
+
+#define STACK_CANARY 0x5a17c0deU
+
+int rt_stack_alloc(struct rt_stack *stack, size_t size)
+{
+	long page_size = sysconf(_SC_PAGESIZE);
+	size_t guard = RT_STACK_GUARD_PAGES * page_size;
+	uint32_t *word, *end;
+	char *mem;
+	int err;
+
+	memset(stack, 0, sizeof(*stack));
+
+	if (!size)
+		size = RT_STACK_DEFAULT_SIZE;
+	size = (size + page_size - 1) & ~(page_size - 1);
+
+	mem = mmap(NULL, guard + size, PROT_READ | PROT_WRITE,
+		   MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+	if (mem == MAP_FAILED)
+		return -1;
+
+	/* stacks grow downwards on all supported architectures */
+	if (mprotect(mem, guard, PROT_NONE) != 0 ||
+	    mlock(mem + guard, size) != 0) {
+		err = errno;
+		munmap(mem, guard + size);
+		errno = err;
+		return -1;
+	}
+
+	/* prefault and paint */
+	end = (uint32_t*) (mem + guard + size);
+	for (word = (uint32_t*) (mem + guard); word < end; word++)
+		*word = STACK_CANARY;
+
+	stack->base  = mem + guard;
+	stack->size  = size;
+	stack->guard = guard;
+	return 0;
+}
+
+void rt_stack_free(struct rt_stack *stack)
+{
+	if (stack->base)
+		munmap(stack->base - stack->guard, stack->guard + stack->size);
+	memset(stack, 0, sizeof(*stack));
+}
+
+size_t rt_stack_high_water(const struct rt_stack *stack)
+{
+	const uint32_t *word = (const uint32_t*) stack->base;
+	const uint32_t *end  = (const uint32_t*) (stack->base + stack->size);
+
+	while (word < end && *word == STACK_CANARY)
+		word++;
+	return (const char*) end - (const char*) word;
+}
+
+int rt_pthread_create(pthread_t *thread, struct rt_stack *stack,
+		      void *(*start_routine)(void*), void *arg)
+{
+	pthread_attr_t attr;
+	int err;
+
+	err = pthread_attr_init(&attr);
+	if (err)
+		return err;
+	err = pthread_attr_setstack(&attr, stack->base, stack->size);
+	if (!err)
+		err = pthread_create(thread, &attr, start_routine, arg);
+	pthread_attr_destroy(&attr);
+	return err;
+}
+
+/* shared by the creating thread and all threads of one batch */
+struct thread_group {
+	pthread_mutex_t lock;
+	pthread_cond_t  all_reported;
+	int pending; /* threads (incl. the creator) yet to report admission */
+	int failed;  /* threads that could not be admitted */
+	int flags;
+	int refs;    /* the last one to drop its reference frees the group */
+};
+
+struct thread_start {
+	struct thread_group *group;
+	struct litmus_thread_spec spec;
+};
+
+static void put_group(struct thread_group *group)
+{
+	if (__sync_sub_and_fetch(&group->refs, 1) == 0) {
+		pthread_cond_destroy(&group->all_reported);
+		pthread_mutex_destroy(&group->lock);
+		free(group);
+	}
+}
+
+/* report admission result and wait until all threads of the group did */
+static int group_barrier(struct thread_group *group, int admitted)
+{
+	int ok;
+
+	pthread_mutex_lock(&group->lock);
+	if (!admitted)
+		group->failed++;
+	if (--group->pending == 0)
+		pthread_cond_broadcast(&group->all_reported);
+	while (group->pending > 0)
+		pthread_cond_wait(&group->all_reported, &group->lock);
+	ok = !group->failed;
+	pthread_mutex_unlock(&group->lock);
+
+	return ok;
+}
+
+/* like group_barrier(), but for a thread that could not be created */
+static void group_report_missing(struct thread_group *group)
+{
+	pthread_mutex_lock(&group->lock);
+	group->failed++;
+	group->pending--;
+	pthread_mutex_unlock(&group->lock);
+	put_group(group);
+}
+
+static int admit_thread(struct litmus_thread_spec *spec)
+{
+	unsigned long long cpus;
+
+	if (spec->domain >= 0) {
+		if (be_migrate_to_domain(spec->domain) != 0)
+			return -1;
+		/* keep a CPU assignment that lies within the domain */
+		if (spec->params.cpu >= 64 ||
+		    domain_to_cpus(spec->domain, &cpus) != 0 ||
+		    !(cpus & (1ULL << spec->params.cpu)))
+			spec->params.cpu = domain_to_first_cpu(spec->domain);
+	}
+	if (set_rt_task_param(gettid(), &spec->params) != 0)
+		return -1;
+	if (init_rt_thread() != 0)
+		return -1;
+	return task_mode(LITMUS_RT_TASK);
+}
+
+static void* litmus_thread_start(void *_start)
+{
+	struct thread_start *start = _start;
+	struct thread_group *group = start->group;
+	void* (*start_routine)(void*) = start->spec.start_routine;
+	void *arg = start->spec.arg;
+	int admitted, ok, flags = group->flags;
+
+	admitted = admit_thread(&start->spec) == 0;
+	free(start);
+
+	ok = group_barrier(group, admitted);
+	put_group(group);
+
+	if (!ok) {
+		/* this or some other thread failed; the batch is torn down */
+		if (admitted)
+			task_mode(BACKGROUND_TASK);
+		return NULL;
+	}
+
+	if (flags & LITMUS_THREADS_WAIT_RELEASE)
+		wait_for_ts_release();
+
+	return start_routine(arg);
+}
+
+int litmus_threads_create(pthread_t *threads,
+			  const struct litmus_thread_spec *specs, int n,
+			  int flags, lt_t *setup_time)
+{
+	struct thread_group *group;
+	struct thread_start *start;
+	pthread_attr_t attr;
+	lt_t t0 = monotonic_ns();
+	int i, ok, created;
+
+	if (n <= 0) {
+		errno = EINVAL;
+		return -1;
+	}
+
+	group = malloc(sizeof(*group));
+	if (!group)
+		return -1;
+	pthread_mutex_init(&group->lock, NULL);
+	pthread_cond_init(&group->all_reported, NULL);
+	group->pending = n + 1; /* including ourselves */
+	group->failed  = 0;
+	group->flags   = flags;
+	group->refs    = n + 1;
+
+	/* Threads set themselves up concurrently; we only spawn them. */
+	for (created = 0; created < n; created++) {
+		start = malloc(sizeof(*start));
+		if (!start)
+			break;
+		start->group = group;
+		start->spec  = specs[created];
+		if (pthread_attr_init(&attr) != 0) {
+			free(start);
+			break;
+		}
+		ok = !specs[created].stack ||
+			pthread_attr_setstack(&attr, specs[created].stack->base,
+					      specs[created].stack->size) == 0;
+		if (ok)
+			ok = pthread_create(threads + created, &attr,
+					    litmus_thread_start, start) == 0;
+		pthread_attr_destroy(&attr);
+		if (!ok) {
+			free(start);
+			break;
+		}
+	}
+
+	/* report on behalf of the threads that were never started */
+	for (i = created; i < n; i++)
+		group_report_missing(group);
+
+	ok = group_barrier(group, 1);
+	put_group(group);
+
+	if (setup_time)
+		*setup_time = monotonic_ns() - t0;
+
+	if (!ok) {
+		for (i = 0; i < created; i++)
+			pthread_join(threads[i], NULL);
+		errno = EAGAIN;
+		return -1;
+	}
+	return 0;
+}
+
+int litmus_thread_create(pthread_t *thread, struct rt_task *params,
+			 void *(*start_routine)(void*), void *arg)
+{
+	struct litmus_thread_spec spec;
+	unsigned long long domains;
+
+	memset(&spec, 0, sizeof(spec));
+	spec.params = *params;
+	spec.start_routine = start_routine;
+	spec.arg = arg;
+
+	/* follow the CPU assignment, if LITMUS^RT reports its domain */
+	spec.domain = -1;
+	if (cpu_to_domains(params->cpu, &domains) == 0 && domains)
+		spec.domain = ffsll(domains) - 1;
+
+	return litmus_threads_create(thread, &spec, 1, 0, NULL);
+}
@@ -10,12 +10,9 @@
 
 #include "litmus.h"
 
-/*	Syscall stub for setting RT mode and scheduling options */
+/* gettid() is cached in src/task.c. */
 
-pid_t gettid(void)
-{
-	return syscall(__NR_gettid);
-}
+/*	Syscall stub for setting RT mode and scheduling options */
 
 int set_rt_task_param(pid_t pid, struct rt_task *param)
 {
@@ -4,18 +4,53 @@
 #include <errno.h>
 
 #include <sched.h>
+#include <pthread.h>
+#include <sys/syscall.h>
 
 #include "litmus.h"
 #include "internal.h"
 
 #define SCHED_NORMAL 0
 
-int task_mode(int mode)
+/* Per-thread state that would otherwise cost a system call on every use.
+ * New threads start with empty caches; fork() copies the TLS of the calling
+ * thread, so the child forgets it. */
+static __thread pid_t cached_tid;
+static __thread int cached_mode = -1;
+static int atfork_registered;
+
+void forget_task_mode(void)
+{
+	cached_mode = -1;
+}
+
+static void forget_thread_state(void)
+{
+	cached_tid = 0;
+	forget_task_mode();
+}
+
+pid_t gettid(void)
+{
+	if (unlikely(!cached_tid)) {
+		if (__sync_bool_compare_and_swap(&atfork_registered, 0, 1))
+			pthread_atfork(NULL, NULL, forget_thread_state);
+		cached_tid = syscall(SYS_gettid);
+	}
+	return cached_tid;
+}
+
+static int current_mode(pid_t me)
+{
+	if (cached_mode < 0)
+		cached_mode = sched_getscheduler(me) == SCHED_LITMUS ?
+			LITMUS_RT_TASK : BACKGROUND_TASK;
+	return cached_mode;
+}
+
+static int switch_mode(pid_t me, int old_mode, int mode)
 {
 	struct sched_param param;
-	int me     = gettid();
-	int policy = sched_getscheduler(gettid());
-	int old_mode = policy == SCHED_LITMUS ? LITMUS_RT_TASK : BACKGROUND_TASK;
 
 	param.sched_priority = 0;
 	if (old_mode == LITMUS_RT_TASK && mode == BACKGROUND_TASK) {
@@ -29,3 +64,43 @@ int task_mode(int mode)
 		return -1;
 	}
 }
+
+int task_mode(int mode)
+{
+	pid_t me = gettid();
+	int cached = cached_mode >= 0;
+	int ret;
+
+	ret = switch_mode(me, current_mode(me), mode);
+	if (ret != 0 && cached) {
+		/* the policy may have been changed behind our back */
+		forget_task_mode();
+		ret = switch_mode(me, current_mode(me), mode);
+	}
+	if (ret == 0)
+		cached_mode = mode;
+	else
+		forget_task_mode();
+	return ret;
+}
+
+int change_rt_task_param(struct rt_task* param, int domain)
+{
+	int was_rt = current_mode(gettid()) == LITMUS_RT_TASK;
+	int ret = -1;
+
+	/* LITMUS^RT rejects parameter changes of real-time tasks */
+	if (was_rt && task_mode(BACKGROUND_TASK) != 0)
+		return -1;
+
+	if (domain >= 0) {
+		if (be_migrate_to_domain(domain) != 0)
+			goto out;
+		param->cpu = domain_to_first_cpu(domain);
+	}
+	ret = set_rt_task_param(gettid(), param);
+out:
+	if (was_rt && task_mode(LITMUS_RT_TASK) != 0)
+		ret = -1;
+	return ret;
+}
@@ -0,0 +1,111 @@
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <string.h>
+
+#include "litmus.h"
+
+#define NSEC_PER_SEC 1000000000ULL
+
+/* default and maximum calibration interval */
+#define CALIBRATION_DEFAULT ms2ns(100)
+#define CALIBRATION_MAX     s2ns(1)
+
+struct cycles_conversion cycles_conv;
+
+#ifdef ASM_CYCLES_NEED_PROBE
+
+int user_cycle_counter = -1;
+
+static sigjmp_buf probe_env;
+
+static void probe_sigill(int sig)
+{
+	siglongjmp(probe_env, 1);
+}
+
+/* Try reading the counter once; if user-space access is not permitted, the
+ * instruction traps with SIGILL and we fall back to the system call. */
+int probe_user_cycle_counter(void)
+{
+	struct sigaction sa, old;
+	volatile int ok = 0;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = probe_sigill;
+	sigemptyset(&sa.sa_mask);
+	if (sigaction(SIGILL, &sa, &old) != 0)
+		return 0;
+
+	if (!sigsetjmp(probe_env, 1)) {
+		read_cntvct();
+		ok = 1;
+	}
+
+	sigaction(SIGILL, &old, NULL);
+	user_cycle_counter = ok;
+	return ok;
+}
+
+#endif
+
+static lt_t raw_clock_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return s2ns((lt_t) ts.tv_sec) + ts.tv_nsec;
+}
+
+void set_cycles_frequency(uint64_t hz)
+{
+	uint32_t shift;
+	uint64_t mult = 0;
+
+	if (!hz)
+		return;
+
+	/* Pick the largest shift (i.e., most precision) for which the
+	 * multiplier still fits into 32 bits. cycles_to_ns() relies on
+	 * shift <= 32. */
+	for (shift = 32; shift > 0; shift--) {
+		mult = ((NSEC_PER_SEC << shift) + hz / 2) / hz;
+		if (mult <= UINT32_MAX)
+			break;
+	}
+
+	cycles_conv.hz    = hz;
+	cycles_conv.shift = shift;
+	cycles_conv.mult  = mult;
+}
+
+uint64_t calibrate_cycles(lt_t duration)
+{
+	uint64_t hz = cycles_nominal_frequency();
+	lt_t t0, t1;
+	cycles_t c0, c1;
+
+	if (!hz) {
+		if (!duration)
+			duration = CALIBRATION_DEFAULT;
+		if (duration > CALIBRATION_MAX)
+			duration = CALIBRATION_MAX;
+
+		t0 = raw_clock_ns();
+		c0 = get_cycles_serialized();
+		if (lt_sleep(duration) != 0)
+			return 0;
+		t1 = raw_clock_ns();
+		c1 = get_cycles_serialized();
+
+		if (t1 <= t0) {
+			errno = EINVAL;
+			return 0;
+		}
+		hz = ((uint64_t) (c1 - c0) * NSEC_PER_SEC) / (t1 - t0);
+	}
+
+	set_cycles_frequency(hz);
+	return hz;
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "litmus.h"
+#include "internal.h"
+#include "topology.h"
+
+#define DEFAULT_SYS_ROOT "/sys"
+
+unsigned long long parse_cpu_list(const char *list)
+{
+	unsigned long long cpus = 0;
+	long first, last;
+	char *end;
+
+	while (*list) {
+		first = strtol(list, &end, 10);
+		if (end == list)
+			break;
+		last = first;
+		if (*end == '-')
+			last = strtol(end + 1, &end, 10);
+		for (; first <= last && first < TOPOLOGY_MAX_CPUS; first++)
+			if (first >= 0)
+				cpus |= 1ULL << first;
+		list = *end == ',' ? end + 1 : end;
+	}
+	return cpus;
+}
+
+static int read_attr(const char *fname, char *buf, size_t len)
+{
+	ssize_t n = read_file(fname, buf, len - 1);
+
+	if (n <= 0)
+		return -1;
+	buf[n] = '\0';
+	if (buf[n - 1] == '\n')
+		buf[n - 1] = '\0';
+	return 0;
+}
+
+static void read_caches(const char *root, int cpu, struct cpu_topology *t)
+{
+	char fname[4096], buf[1024];
+	int index, level;
+
+	for (index = 0; ; index++) {
+		snprintf(fname, sizeof(fname),
+			 "%s/devices/system/cpu/cpu%d/cache/index%d/level",
+			 root, cpu, index);
+		if (read_attr(fname, buf, sizeof(buf)) != 0)
+			break;
+		level = atoi(buf);
+		if (level < 1 || level > TOPOLOGY_MAX_LEVELS)
+			continue;
+
+		snprintf(fname, sizeof(fname),
+			 "%s/devices/system/cpu/cpu%d/cache/index%d/type",
+			 root, cpu, index);
+		if (read_attr(fname, buf, sizeof(buf)) == 0 &&
+		    !strcmp(buf, "Instruction"))
+			continue;
+
+		snprintf(fname, sizeof(fname),
+			 "%s/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list",
+			 root, cpu, index);
+		if (read_attr(fname, buf, sizeof(buf)) != 0)
+			continue;
+		t->cache[level][cpu] = parse_cpu_list(buf) | (1ULL << cpu);
+		if (level > t->levels)
+			t->levels = level;
+	}
+}
+
+static void read_nodes(const char *root, struct cpu_topology *t)
+{
+	char fname[4096], buf[1024];
+	unsigned long long cpus;
+	int node, cpu, missing = 0;
+
+	/* node IDs may have gaps */
+	for (node = 0; missing < 64; node++) {
+		snprintf(fname, sizeof(fname),
+			 "%s/devices/system/node/node%d/cpulist", root, node);
+		if (read_attr(fname, buf, sizeof(buf)) != 0) {
+			missing++;
+			continue;
+		}
+		cpus = parse_cpu_list(buf);
+		for (cpu = 0; cpu < TOPOLOGY_MAX_CPUS; cpu++)
+			if (cpus & (1ULL << cpu))
+				t->node[cpu] = cpus;
+	}
+}
+
+int read_cpu_topology(const char *sys_root, struct cpu_topology *t)
+{
+	const char *root = sys_root ? sys_root : DEFAULT_SYS_ROOT;
+	char fname[4096], buf[1024];
+	int cpu;
+
+	memset(t, 0, sizeof(*t));
+
+	snprintf(fname, sizeof(fname), "%s/devices/system/cpu/online", root);
+	if (read_attr(fname, buf, sizeof(buf)) == 0)
+		t->cpus = parse_cpu_list(buf);
+	if (!t->cpus)
+		return -1;
+
+	for (cpu = 0; cpu < TOPOLOGY_MAX_CPUS; cpu++)
+		if (t->cpus & (1ULL << cpu))
+			read_caches(root, cpu, t);
+	read_nodes(root, t);
+	return 0;
+}
+
+static const unsigned long long* group_map(const struct cpu_topology *t,
+					   int level)
+{
+	return level ? t->cache[level] : t->node;
+}
+
+int topology_groups(const struct cpu_topology *t, int level,
+		    unsigned long long *groups, int max)
+{
+	const unsigned long long *map;
+	unsigned long long seen = 0;
+	int cpu, n = 0;
+
+	if (level < 0 || level > TOPOLOGY_MAX_LEVELS)
+		return 0;
+	map = group_map(t, level);
+	for (cpu = 0; cpu < TOPOLOGY_MAX_CPUS; cpu++) {
+		if (!(t->cpus & (1ULL << cpu)) || (seen & (1ULL << cpu)) ||
+		    !map[cpu])
+			continue;
+		seen |= map[cpu];
+		if (n < max)
+			groups[n] = map[cpu] & t->cpus;
+		n++;
+	}
+	return n;
+}
+
+static int within_one_group(const unsigned long long *map,
+			    unsigned long long cpus)
+{
+	int first = __builtin_ctzll(cpus);
+
+	return map[first] && (cpus & ~map[first]) == 0;
+}
+
+int shared_cache_level(const struct cpu_topology *t, unsigned long long cpus)
+{
+	int level;
+
+	if (!cpus)
+		return 0;
+	for (level = 1; level <= t->levels; level++)
+		if (within_one_group(t->cache[level], cpus))
+			return level;
+	return 0;
+}
+
+int split_cache_level(const struct cpu_topology *t, unsigned long long cpus)
+{
+	int level, cpu, shared = shared_cache_level(t, cpus);
+
+	/* at the shared level and above, cpus are part of one cache anyway */
+	for (level = 1; level <= t->levels && (!shared || level < shared);
+	     level++)
+		for (cpu = 0; cpu < TOPOLOGY_MAX_CPUS; cpu++)
+			if ((cpus & (1ULL << cpu)) &&
+			    (t->cache[level][cpu] & t->cpus & ~cpus))
+				return level;
+	return 0;
+}
+
+int spans_nodes(const struct cpu_topology *t, unsigned long long cpus)
+{
+	return cpus && t->node[__builtin_ctzll(cpus)] &&
+		!within_one_group(t->node, cpus);
+}
+
+static int add_advice(struct cluster_advice *advice, int n, int max,
+		      int size, int nclusters, int level, const char *why)
+{
+	int i;
+
+	for (i = 0; i < n; i++)
+		if (advice[i].size == size)
+			return n; /* an earlier reason explains it */
+	if (n == max)
+		return n;
+	for (i = n; i > 0 && advice[i - 1].size > size; i--)
+		advice[i] = advice[i - 1];
+	advice[i].size      = size;
+	advice[i].nclusters = nclusters;
+	advice[i].level     = level;
+	advice[i].why       = why;
+	return n + 1;
+}
+
+/* size of the groups if they are equally large and cover all CPUs */
+static int uniform_size(const struct cpu_topology *t, int level)
+{
+	unsigned long long groups[TOPOLOGY_MAX_CPUS], all = 0;
+	int i, n, size;
+
+	n = topology_groups(t, level, groups, TOPOLOGY_MAX_CPUS);
+	if (!n)
+		return 0;
+	size = __builtin_popcountll(groups[0]);
+	for (i = 0; i < n; i++) {
+		if (__builtin_popcountll(groups[i]) != size ||
+		    (all & groups[i]))
+			return 0;
+		all |= groups[i];
+	}
+	return all == t->cpus ? size : 0;
+}
+
+int recommend_cluster_sizes(const struct cpu_topology *t,
+			    struct cluster_advice *advice, int max)
+{
+	static const char *names[TOPOLOGY_MAX_LEVELS + 1] = {
+		NULL, "shared L1", "shared L2", "shared L3", "shared L4"
+	};
+	int ncpus = __builtin_popcountll(t->cpus);
+	int level, size, n = 0;
+
+	/* private caches add nothing to partitioned scheduling */
+	n = add_advice(advice, n, max, 1, ncpus, 0, "partitioned");
+	for (level = 1; level <= t->levels; level++) {
+		size = uniform_size(t, level);
+		if (size)
+			n = add_advice(advice, n, max, size, ncpus / size,
+				       level, names[level]);
+	}
+	size = uniform_size(t, 0);
+	if (size)
+		n = add_advice(advice, n, max, size, ncpus / size, 0,
+			       "NUMA node");
+	n = add_advice(advice, n, max, ncpus, 1, 0, "global");
+	return n;
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tests.h"
+#include "litmus.h"
+#include "topology.h"
+#include "numa.h"
+
+static void write_cache_attr(const char *root, int cpu, int index,
+			     const char *attr, const char *content)
+{
+	char path[128];
+
+	snprintf(path, sizeof(path), "devices/system/cpu/cpu%d/cache/index%d/%s",
+		 cpu, index, attr);
+	write_fixture(root, path, content);
+}
+
+static void write_cache(const char *root, int cpu, int index, int level,
+			const char *type, const char *shared)
+{
+	char buf[16];
+
+	snprintf(buf, sizeof(buf), "%d\n", level);
+	write_cache_attr(root, cpu, index, "level", buf);
+	write_cache_attr(root, cpu, index, "type", type);
+	write_cache_attr(root, cpu, index, "shared_cpu_list", shared);
+}
+
+/* a fake /sys with four CPUs: private L1s, an L2 per pair of CPUs, one L3,
+ * and one NUMA node per pair of CPUs */
+static void make_sys_fixture(char *root)
+{
+	static const char *l1[] = {"0\n", "1\n", "2\n", "3\n"};
+	static const char *l2[] = {"0-1\n", "0-1\n", "2-3\n", "2-3\n"};
+	int cpu;
+
+	make_fixture_tree(root);
+	write_fixture(root, "devices/system/cpu/online", "0-3\n");
+	for (cpu = 0; cpu < 4; cpu++) {
+		write_cache(root, cpu, 0, 1, "Data\n", l1[cpu]);
+		/* instruction caches do not matter for data placement */
+		write_cache(root, cpu, 1, 1, "Instruction\n", "0-3\n");
+		write_cache(root, cpu, 2, 2, "Unified\n", l2[cpu]);
+		write_cache(root, cpu, 3, 3, "Unified\n", "0-3\n");
+	}
+	write_fixture(root, "devices/system/node/node0/cpulist", "0-1\n");
+	write_fixture(root, "devices/system/node/node1/cpulist", "2-3\n");
+}
+
+TESTCASE(cache_topology_fixture, ALL,
+	 "cache and node groups are read from sysfs and sizes recommended")
+{
+	char root[] = "/tmp/litmus-sys-XXXXXX";
+	struct cpu_topology t;
+	struct cluster_advice advice[TOPOLOGY_MAX_ADVICE];
+	unsigned long long groups[4];
+
+	make_sys_fixture(root);
+	SYSCALL( read_cpu_topology(root, &t) );
+	ASSERT( t.cpus == 0xf );
+	ASSERT( t.levels == 3 );
+
+	ASSERT( topology_groups(&t, 1, groups, 4) == 4 );
+	ASSERT( topology_groups(&t, 2, groups, 4) == 2 );
+	ASSERT( groups[0] == 0x3 && groups[1] == 0xc );
+	ASSERT( topology_groups(&t, 3, groups, 4) == 1 );
+	ASSERT( groups[0] == 0xf );
+	ASSERT( topology_groups(&t, 0, groups, 4) == 2 );
+	ASSERT( groups[0] == 0x3 && groups[1] == 0xc );
+
+	ASSERT( shared_cache_level(&t, 0x1) == 1 );
+	ASSERT( shared_cache_level(&t, 0x3) == 2 );
+	ASSERT( shared_cache_level(&t, 0x6) == 3 );
+	/* whole caches below the shared level, or parts of them */
+	ASSERT( split_cache_level(&t, 0x1) == 0 );
+	ASSERT( split_cache_level(&t, 0x3) == 0 );
+	ASSERT( split_cache_level(&t, 0xf) == 0 );
+	ASSERT( split_cache_level(&t, 0x6) == 2 );
+	ASSERT( split_cache_level(&t, 0x7) == 2 );
+	ASSERT( !spans_nodes(&t, 0x3) );
+	ASSERT( spans_nodes(&t, 0x6) );
+
+	ASSERT( recommend_cluster_sizes(&t, advice, TOPOLOGY_MAX_ADVICE) == 3 );
+	ASSERT( advice[0].size == 1 && advice[0].nclusters == 4 );
+	ASSERT( advice[1].size == 2 && advice[1].nclusters == 2 );
+	ASSERT( advice[1].level == 2 );
+	ASSERT( advice[2].size == 4 && advice[2].level == 3 );
+
+	remove_fixture_tree(root);
+}
+
+TESTCASE(cpus_to_node_fixture, ALL,
+	 "sets of CPUs are mapped to the NUMA node that contains them")
+{
+	char root[] = "/tmp/litmus-sys-XXXXXX";
+
+	make_sys_fixture(root);
+	ASSERT( cpus_to_node(root, 0x1) == 0 );
+	ASSERT( cpus_to_node(root, 0x3) == 0 );
+	ASSERT( cpus_to_node(root, 0xc) == 1 );
+	ASSERT( cpus_to_node(root, 0x6) == -1 );
+	ASSERT( cpus_to_node(root, 0x10) == -1 );
+	remove_fixture_tree(root);
+}
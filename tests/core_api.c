@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sched.h>
+#include <string.h>
 
 #include "tests.h"
 #include "litmus.h"
@@ -168,6 +169,53 @@ TESTCASE(ctrl_page_writable, ALL,
 	ctrl_page[32] = 0x12345678;
 }
 
+TESTCASE(np_stats_accounting, ALL,
+	 "enter_np()/exit_np() account NP sections when enabled")
+{
+	struct np_stats stats, snap;
+	cycles_t start, end;
+
+	memset(&stats, 0, sizeof(stats));
+
+	/* not accounted while disabled */
+	enter_np();
+	exit_np();
+
+	enable_np_stats(&stats);
+
+	/* nested sections count as one */
+	enter_np();
+	enter_np();
+	exit_np();
+	exit_np();
+
+	enter_np();
+	exit_np();
+
+	enable_np_stats(NULL);
+
+	enter_np();
+	exit_np();
+
+	read_np_stats(&stats, &snap);
+	ASSERT( snap.sections == 2 );
+	ASSERT( snap.max_cycles <= snap.total_cycles );
+	ASSERT( (snap.seq & 1) == 0 );
+
+	/* enabled inside a section: accounted from the time of the call */
+	memset(&stats, 0, sizeof(stats));
+	start = get_cycles();
+	enter_np();
+	enable_np_stats(&stats);
+	exit_np();
+	end = get_cycles();
+	enable_np_stats(NULL);
+
+	read_np_stats(&stats, &snap);
+	ASSERT( snap.sections == 1 );
+	ASSERT( snap.total_cycles <= end - start );
+}
+
 
 TESTCASE(suspended_admission, LITMUS,
 	 "admission control handles suspended tasks correctly")
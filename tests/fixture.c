@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+#include "tests.h"
+
+void make_fixture_tree(char *root)
+{
+	ASSERT( mkdtemp(root) != NULL );
+}
+
+void write_fixture(const char *root, const char *path, const char *content)
+{
+	char fname[512];
+	char *slash;
+	FILE *f;
+
+	ASSERT( snprintf(fname, sizeof(fname), "%s/%s", root, path)
+		< (int) sizeof(fname) );
+	/* create the missing parent directories below root */
+	for (slash = strchr(fname + strlen(root) + 1, '/'); slash;
+	     slash = strchr(slash + 1, '/')) {
+		*slash = '\0';
+		if (mkdir(fname, 0700) != 0)
+			ASSERT( errno == EEXIST );
+		*slash = '/';
+	}
+	f = fopen(fname, "w");
+	ASSERT( f != NULL );
+	fputs(content, f);
+	fclose(f);
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int type,
+			struct FTW *ftw)
+{
+	return type == FTW_DP ? rmdir(path) : unlink(path);
+}
+
+void remove_fixture_tree(const char *root)
+{
+	/* depth first, so that directories are empty when removed */
+	SYSCALL( nftw(root, remove_entry, 16, FTW_DEPTH | FTW_PHYS) );
+}
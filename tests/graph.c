@@ -0,0 +1,119 @@
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+#include "tests.h"
+#include "litmus.h"
+#include "rt_graph.h"
+
+TESTCASE(rt_hist_buckets, ALL,
+	 "latency histograms bucket by powers of two")
+{
+	struct rt_hist h;
+	int i;
+
+	memset(&h, 0, sizeof(h));
+	ASSERT( rt_hist_quantile(&h, 0.5) == 0 );
+
+	rt_hist_add(&h, 0);
+	rt_hist_add(&h, 1);
+	rt_hist_add(&h, 1000);
+	for (i = 0; i < 97; i++)
+		rt_hist_add(&h, 100);
+
+	ASSERT( h.count == 100 );
+	ASSERT( h.max == 1000 );
+	ASSERT( h.sum == 1 + 1000 + 9700 );
+	ASSERT( h.buckets[0] == 1 );
+	ASSERT( h.buckets[1] == 1 );
+	ASSERT( h.buckets[7] == 97 );  /* 64 <= 100 < 128 */
+	ASSERT( h.buckets[10] == 1 );  /* 512 <= 1000 < 1024 */
+
+	ASSERT( rt_hist_quantile(&h, 0.5) == 127 );
+	ASSERT( rt_hist_quantile(&h, 0.99) == 127 );
+	ASSERT( rt_hist_quantile(&h, 1.0) == 1000 );
+	ASSERT( rt_hist_quantile(&h, 0.0) == 0 );
+}
+
+static int pass_on(int node, const uint64_t *in, int nin, uint64_t *out,
+		   void *arg)
+{
+	int *remaining = arg;
+	int i;
+
+	*out = node;
+	for (i = 0; i < nin; i++)
+		*out += in[i];
+	return remaining && --*remaining == 0;
+}
+
+TESTCASE(rt_graph_rejects_cycles, ALL,
+	 "processing graphs must be acyclic")
+{
+	struct rt_graph g;
+	struct rt_task params;
+	int a, b;
+
+	init_rt_task_param(&params);
+	params.exec_cost = ms2ns(1);
+	params.period    = ms2ns(10);
+
+	rt_graph_init(&g);
+	a = rt_graph_add_node(&g, "a", &params, -1, pass_on, NULL);
+	b = rt_graph_add_node(&g, "b", &params, -1, pass_on, NULL);
+	ASSERT( a == 0 && b == 1 );
+
+	SYSCALL_FAILS( EINVAL, rt_graph_add_edge(&g, a, a, 1) );
+	SYSCALL_FAILS( EINVAL, rt_graph_add_edge(&g, a, 2, 1) );
+	ASSERT( rt_graph_add_edge(&g, a, b, 3) == 0 );
+	ASSERT( g.edges[0].capacity == 4 );
+	ASSERT( rt_graph_add_edge(&g, b, a, 1) == 1 );
+
+	SYSCALL_FAILS( EINVAL, rt_graph_start(&g) );
+	ASSERT( rt_graph_critical_path(&g) == -1 );
+}
+
+TESTCASE(rt_graph_diamond, LITMUS,
+	 "tokens flow through a diamond and sinks track path latencies")
+{
+	struct rt_graph g;
+	struct rt_task periodic, sporadic;
+	int src, left, right, sink, waiters, remaining = 5;
+	lt_t delay = ms2ns(10);
+
+	init_rt_task_param(&periodic);
+	periodic.exec_cost = ms2ns(1);
+	periodic.period    = ms2ns(20);
+	periodic.release_policy = TASK_PERIODIC;
+	sporadic = periodic;
+	sporadic.release_policy = TASK_SPORADIC;
+
+	rt_graph_init(&g);
+	src   = rt_graph_add_node(&g, "src", &periodic, 0, pass_on, NULL);
+	left  = rt_graph_add_node(&g, "left", &sporadic, 0, pass_on, NULL);
+	right = rt_graph_add_node(&g, "right", &sporadic, 0, pass_on, NULL);
+	sink  = rt_graph_add_node(&g, "sink", &sporadic, 0, pass_on,
+				  &remaining);
+	SYSCALL( rt_graph_add_edge(&g, src, left, 4) );
+	SYSCALL( rt_graph_add_edge(&g, src, right, 4) );
+	SYSCALL( rt_graph_add_edge(&g, left, sink, 4) );
+	SYSCALL( rt_graph_add_edge(&g, right, sink, 4) );
+
+	SYSCALL( rt_graph_start(&g) );
+	do {
+		waiters = get_nr_ts_release_waiters();
+		ASSERT( waiters >= 0 );
+	} while (waiters != g.nnodes);
+	SYSCALL( release_ts(&delay) );
+	rt_graph_join(&g);
+
+	ASSERT( remaining == 0 );
+	ASSERT( g.nodes[sink].jobs == 5 );
+	ASSERT( g.nodes[src].jobs >= 5 );
+	ASSERT( rt_graph_critical_path(&g) >= 0 );
+	/* all paths pass through source and sink */
+	ASSERT( g.paths[0].nodes & (1ULL << src) );
+	ASSERT( g.paths[0].nodes & (1ULL << sink) );
+	ASSERT( g.edges[2].delay.count == 5 );
+	ASSERT( g.untracked == 0 );
+}
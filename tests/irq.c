@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "tests.h"
+#include "litmus.h"
+#include "irq_shield.h"
+
+static void read_fixture(const char *root, const char *path, char *buf)
+{
+	char fname[256];
+	FILE *f;
+
+	snprintf(fname, sizeof(fname), "%s/%s", root, path);
+	f = fopen(fname, "r");
+	ASSERT( f != NULL );
+	ASSERT( fscanf(f, "%63s", buf) == 1 );
+	fclose(f);
+}
+
+/* a fake /proc with three interrupts on four CPUs */
+static void make_proc_fixture(char *root)
+{
+	make_fixture_tree(root);
+	write_fixture(root, "irq/default_smp_affinity", "f\n");
+	write_fixture(root, "irq/0/smp_affinity", "f\n");
+	write_fixture(root, "irq/1/smp_affinity", "2\n");
+	write_fixture(root, "irq/24/smp_affinity", "00000000,00000003\n");
+	write_fixture(root, "interrupts",
+		"           CPU0       CPU1       CPU3\n"
+		"  0:         10          0          5   IO-APIC   2-edge   timer\n"
+		" 24:          1          2          3   PCI-MSI 512000-edge  eth0\n"
+		"LOC:        100        200        300   Local timer interrupts\n"
+		"ERR:          7\n");
+}
+
+TESTCASE(irq_shield_fixture, ALL,
+	 "IRQ affinities are steered off shielded CPUs and restored")
+{
+	char root[] = "/tmp/litmus-irq-XXXXXX";
+	char mask[64];
+	struct irq_shield_result r;
+	FILE *snapshot;
+
+	make_proc_fixture(root);
+	snapshot = tmpfile();
+	ASSERT( snapshot != NULL );
+	SYSCALL( save_irq_affinity(root, snapshot) );
+
+	SYSCALL( irq_shield_cpus(root, 0x2, &r) );
+	ASSERT( r.changed == 4 && r.unchanged == 0 && r.failed == 0 );
+	read_fixture(root, "irq/default_smp_affinity", mask);
+	ASSERT( !strcmp(mask, "d") );
+	read_fixture(root, "irq/0/smp_affinity", mask);
+	ASSERT( !strcmp(mask, "d") );
+	/* only on a shielded CPU: moved to the default */
+	read_fixture(root, "irq/1/smp_affinity", mask);
+	ASSERT( !strcmp(mask, "d") );
+	/* the width of wide masks is kept */
+	read_fixture(root, "irq/24/smp_affinity", mask);
+	ASSERT( !strcmp(mask, "00000000,00000001") );
+
+	SYSCALL( irq_shield_cpus(root, 0x2, &r) );
+	ASSERT( r.changed == 0 && r.unchanged == 4 );
+
+	rewind(snapshot);
+	SYSCALL( restore_irq_affinity(root, snapshot, &r) );
+	ASSERT( r.changed == 4 && r.failed == 0 );
+	read_fixture(root, "irq/1/smp_affinity", mask);
+	ASSERT( !strcmp(mask, "2") );
+	read_fixture(root, "irq/24/smp_affinity", mask);
+	ASSERT( !strcmp(mask, "00000000,00000003") );
+
+	fclose(snapshot);
+	remove_fixture_tree(root);
+}
+
+TESTCASE(irq_counts_fixture, ALL,
+	 "per-CPU interrupt counts are summed from /proc/interrupts")
+{
+	char root[] = "/tmp/litmus-irq-XXXXXX";
+	uint64_t counts[8];
+
+	make_proc_fixture(root);
+	ASSERT( read_irq_counts(root, counts, 8) == 4 );
+	ASSERT( counts[0] == 111 );
+	ASSERT( counts[1] == 202 );
+	ASSERT( counts[2] == 0 );
+	ASSERT( counts[3] == 308 );
+	ASSERT( read_irq_counts(root, counts, 2) == -1 );
+	remove_fixture_tree(root);
+}
@@ -0,0 +1,340 @@
+#include <unistd.h>
+#include <string.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+
+#include "tests.h"
+#include "litmus.h"
+#include "job_runner.h"
+#include "exec_estimator.h"
+#include "mode_change.h"
+#include "mk_firm.h"
+#include "event_task.h"
+
+struct job_counter {
+	int remaining;
+	int misses;
+};
+
+static int count_down(void *arg)
+{
+	struct job_counter *c = arg;
+	return --c->remaining == 0;
+}
+
+static void count_miss(const struct job_timing *t, void *arg)
+{
+	struct job_counter *c = arg;
+	c->misses++;
+}
+
+TESTCASE(job_runner_stats, LITMUS,
+	 "job runner invokes each job once and keeps consistent statistics")
+{
+	struct job_runner runner;
+	struct job_stats snap;
+	struct job_counter counter = {5, 0};
+
+	SYSCALL( sporadic_partitioned(ms2ns(2), ms2ns(20), 0) );
+	SYSCALL( init_job_runner(&runner, count_down, &counter) );
+	runner.on_miss = count_miss;
+
+	SYSCALL( task_mode(LITMUS_RT_TASK) );
+	SYSCALL( run_jobs(&runner) );
+	SYSCALL( task_mode(BACKGROUND_TASK) );
+
+	ASSERT( counter.remaining == 0 );
+	read_job_stats(runner.stats, &snap);
+	ASSERT( snap.jobs == 5 );
+	ASSERT( snap.misses == counter.misses );
+	ASSERT( snap.seq % 2 == 0 );
+	ASSERT( snap.max_response <= snap.total_response );
+	ASSERT( snap.max_exec <= snap.total_exec );
+}
+
+TESTCASE(job_runner_non_rt, ALL,
+	 "job runner refuses to run for non-rt tasks")
+{
+	struct job_runner runner;
+	struct job_counter counter = {1, 0};
+	struct rt_task params;
+
+	init_rt_task_param(&params);
+	params.exec_cost = ms2ns(10);
+	params.period    = ms2ns(100);
+	SYSCALL( set_rt_task_param(gettid(), &params) );
+
+	SYSCALL( init_job_runner(&runner, count_down, &counter) );
+	SYSCALL_FAILS( EINVAL, run_jobs(&runner) );
+	ASSERT( counter.remaining == 1 );
+}
+
+TESTCASE(exec_estimator_quantile, ALL,
+	 "execution-time estimator tracks quantile, average, and maximum")
+{
+	struct exec_estimator est;
+	unsigned int i, x = 1;
+	lt_t q;
+
+	init_exec_estimator(&est, 0.9, 0);
+	ASSERT( exec_estimate_quantile(&est) == 0 );
+
+	/* few samples: nearest rank */
+	exec_estimator_add(&est, 30);
+	exec_estimator_add(&est, 10);
+	exec_estimator_add(&est, 20);
+	ASSERT( exec_estimate_quantile(&est) == 30 );
+	ASSERT( est.ewma == 20 );
+	ASSERT( est.max == 30 );
+
+	/* uniformly distributed over [0, 10000) in pseudo-random order */
+	init_exec_estimator(&est, 0.9, 4);
+	for (i = 0; i < 10000; i++) {
+		x = (x * 1103515245 + 12345) & 0x7fffffff;
+		exec_estimator_add(&est, x % 10000);
+	}
+	q = exec_estimate_quantile(&est);
+	ASSERT( q > 8800 && q < 9200 );
+	ASSERT( est.max >= 9990 && est.max < 10000 );
+	ASSERT( est.samples == 10000 );
+}
+
+TESTCASE(exec_budget_recommendation, ALL,
+	 "budget recommendations honour margin, bounds, and hysteresis")
+{
+	struct exec_estimator est;
+	struct exec_budget_policy policy;
+	int i;
+
+	init_exec_estimator(&est, 0.5, 3);
+	memset(&policy, 0, sizeof(policy));
+	policy.estimate = EXEC_EST_MAX;
+	policy.margin_pct = 10;
+	policy.warmup = 10;
+
+	for (i = 0; i < 9; i++)
+		exec_estimator_add(&est, 1000);
+	ASSERT( recommend_exec_cost(&est, &policy, 5000) == 5000 );
+	exec_estimator_add(&est, 1000);
+	ASSERT( recommend_exec_cost(&est, &policy, 5000) == 1100 );
+
+	policy.min_budget = 2000;
+	ASSERT( recommend_exec_cost(&est, &policy, 5000) == 2000 );
+	policy.min_budget = 0;
+	policy.max_budget = 1050;
+	ASSERT( recommend_exec_cost(&est, &policy, 5000) == 1050 );
+	policy.max_budget = 0;
+
+	policy.hysteresis_pct = 10;
+	ASSERT( recommend_exec_cost(&est, &policy, 1050) == 1050 );
+	ASSERT( recommend_exec_cost(&est, &policy, 1300) == 1100 );
+
+	policy.flags = EXEC_BUDGET_NO_SHRINK;
+	ASSERT( recommend_exec_cost(&est, &policy, 5000) == 5000 );
+	ASSERT( recommend_exec_cost(&est, &policy, 500) == 1100 );
+	policy.flags = EXEC_BUDGET_NO_GROW;
+	ASSERT( recommend_exec_cost(&est, &policy, 500) == 500 );
+
+	policy.flags = 0;
+	policy.estimate = EXEC_EST_EWMA;
+	policy.margin_pct = 0;
+	ASSERT( recommend_exec_cost(&est, &policy, 5000) == 1000 );
+}
+
+TESTCASE(mode_change_generations, LITMUS,
+	 "mode changes are applied at job boundaries and acknowledged")
+{
+	struct mode_change_region *region;
+	struct mode_change_task task;
+	struct rt_task params, applied;
+	uint32_t gen;
+
+	region = calloc(1, sizeof(*region) + 2 * sizeof(region->slots[0]));
+	ASSERT( region != NULL );
+	region->ntasks = 2;
+
+	SYSCALL( sporadic_partitioned(ms2ns(2), ms2ns(20), 0) );
+	SYSCALL( get_rt_task_param(gettid(), &params) );
+	SYSCALL( task_mode(LITMUS_RT_TASK) );
+
+	SYSCALL( mode_change_attach(&task, region, 0) );
+	SYSCALL_FAILS( EINVAL, mode_change_attach(&task, region, 2) );
+	ASSERT( mode_change_poll(&task, NULL) == 0 );
+
+	/* a generation that does not touch our slot is merely acknowledged */
+	gen = mode_change_commit(region);
+	ASSERT( mode_change_pending(region, gen) == 0 );
+	ASSERT( mode_change_poll(&task, NULL) == 0 );
+	ASSERT( region->slots[0].acked == gen );
+
+	params.period = ms2ns(40);
+	params.exec_cost = ms2ns(4);
+	SYSCALL( mode_change_set(region, 0, &params, -1) );
+	gen = mode_change_commit(region);
+	ASSERT( mode_change_pending(region, gen) == 1 );
+	SYSCALL_FAILS( ETIMEDOUT, mode_change_wait(region, gen, ms2ns(5)) );
+
+	/* a slot that is being rewritten is left for the next job boundary */
+	region->slots[0].seq++;
+	ASSERT( mode_change_poll(&task, NULL) == 0 );
+	ASSERT( mode_change_pending(region, gen) == 1 );
+	region->slots[0].seq++;
+
+	SYSCALL( sleep_next_period() );
+	ASSERT( mode_change_poll(&task, &applied) == 1 );
+	ASSERT( applied.period == ms2ns(40) );
+	ASSERT( mode_change_pending(region, gen) == 0 );
+	SYSCALL( mode_change_wait(region, gen, 0) );
+
+	SYSCALL( get_rt_task_param(gettid(), &params) );
+	ASSERT( params.period == ms2ns(40) );
+	ASSERT( params.exec_cost == ms2ns(4) );
+
+	/* still a real-time task */
+	SYSCALL( sleep_next_period() );
+	SYSCALL( task_mode(BACKGROUND_TASK) );
+	free(region);
+}
+
+TESTCASE(mk_firm_skipping, ALL,
+	 "(m,k)-firm constraint bounds the number of skipped jobs")
+{
+	struct mk_firm mk;
+
+	SYSCALL_FAILS( EINVAL, init_mk_firm(&mk, 0, 4, 0) );
+	SYSCALL_FAILS( EINVAL, init_mk_firm(&mk, 5, 4, 0) );
+	SYSCALL_FAILS( EINVAL, init_mk_firm(&mk, 1, MK_FIRM_MAX_K + 1, 0) );
+
+	/* at least 3 out of any 5 jobs */
+	SYSCALL( init_mk_firm(&mk, 3, 5, ms2ns(1)) );
+	ASSERT( mk_firm_skippable(&mk, 0) == 0 );
+	ASSERT( mk_firm_skippable(&mk, 10) == 2 );
+
+	mk_firm_record(&mk, 0);
+	ASSERT( mk_firm_skippable(&mk, 10) == 1 );
+	mk_firm_skip(&mk, 1);
+	ASSERT( mk_firm_skippable(&mk, 10) == 0 );
+	ASSERT( mk.skipped == 1 );
+	ASSERT( mk.violations == 0 );
+
+	/* misses shift out of the window again */
+	mk_firm_record(&mk, 1);
+	mk_firm_record(&mk, 1);
+	ASSERT( mk_firm_skippable(&mk, 10) == 0 );
+	mk_firm_record(&mk, 1);
+	ASSERT( mk_firm_skippable(&mk, 1) == 1 );
+	ASSERT( mk_firm_skippable(&mk, 10) == 2 );
+	mk_firm_record(&mk, 1);
+
+	mk_firm_record(&mk, 0);
+	mk_firm_record(&mk, 0);
+	mk_firm_record(&mk, 0);
+	ASSERT( mk.violations == 1 );
+
+	/* full-width windows */
+	SYSCALL( init_mk_firm(&mk, 1, MK_FIRM_MAX_K, 0) );
+	ASSERT( mk_firm_skippable(&mk, 100) == MK_FIRM_MAX_K - 1 );
+}
+
+struct event_log {
+	int fd;
+	int calls;
+	uint64_t events[2];
+	lt_t start[2];
+};
+
+static int log_events(int fd, uint64_t events, void *arg)
+{
+	struct event_log *log = arg;
+	uint64_t one = 1;
+
+	log->events[log->calls] = events;
+	log->start[log->calls] = monotonic_ns();
+	log->calls++;
+	if (log->calls == 1)
+		/* trigger the next job right away */
+		return write(fd, &one, sizeof(one)) != sizeof(one);
+	return 1;
+}
+
+TESTCASE(event_task_eventfd, LITMUS,
+	 "event tasks coalesce bursts and enforce the minimum inter-arrival time")
+{
+	struct event_task et;
+	struct event_log log;
+	uint64_t burst = 3;
+	int fd;
+
+	fd = eventfd(0, 0);
+	ASSERT( fd >= 0 );
+	memset(&log, 0, sizeof(log));
+
+	SYSCALL( sporadic_partitioned(ms2ns(2), ms2ns(20), 0) );
+	SYSCALL( init_event_task(&et, fd, EVENT_SOURCE_EVENTFD, log_events,
+				 &log) );
+	ASSERT( et.min_interarrival == ms2ns(20) );
+
+	ASSERT( write(fd, &burst, sizeof(burst)) == sizeof(burst) );
+
+	SYSCALL( task_mode(LITMUS_RT_TASK) );
+	SYSCALL( run_event_task(&et) );
+	SYSCALL( task_mode(BACKGROUND_TASK) );
+
+	ASSERT( log.calls == 2 );
+	ASSERT( log.events[0] == 3 );
+	ASSERT( log.events[1] == 1 );
+	ASSERT( log.start[1] - log.start[0] >= ms2ns(19) );
+	ASSERT( et.stats.jobs == 2 );
+	ASSERT( et.stats.events == 4 );
+	ASSERT( et.stats.coalesced == 2 );
+	ASSERT( et.stats.delayed == 1 );
+
+	close(fd);
+}
+
+TESTCASE(event_task_requires_sporadic, ALL,
+	 "event tasks reject periodic release policies")
+{
+	struct event_task et;
+	struct rt_task params;
+
+	init_rt_task_param(&params);
+	params.exec_cost = ms2ns(10);
+	params.period    = ms2ns(100);
+	params.release_policy = TASK_PERIODIC;
+	SYSCALL( set_rt_task_param(gettid(), &params) );
+
+	SYSCALL_FAILS( EINVAL, init_event_task(&et, 0, EVENT_SOURCE_STREAM,
+					       log_events, NULL) );
+}
+
+TESTCASE(job_state_matches_job_no, LITMUS,
+	 "get_job_state() agrees with get_job_no() and the task's period")
+{
+	struct job_state prev, cur;
+	unsigned int job_no;
+	int i;
+
+	SYSCALL( sporadic_partitioned(ms2ns(2), ms2ns(10), 0) );
+	SYSCALL( task_mode(LITMUS_RT_TASK) );
+
+	SYSCALL( sleep_next_period() );
+	SYSCALL( get_job_state(&prev) );
+	for (i = 0; i < 3; i++) {
+		SYSCALL( sleep_next_period() );
+		SYSCALL( get_job_state(&cur) );
+		SYSCALL( get_job_no(&job_no) );
+		ASSERT( cur.job_no == job_no );
+		ASSERT( cur.job_no == prev.job_no + 1 );
+		if (job_state_in_ctrl_page()) {
+			ASSERT( cur.release >= prev.release + ms2ns(10) );
+			ASSERT( cur.deadline == cur.release + ms2ns(10) );
+			ASSERT( cur.release <= monotonic_ns() );
+		} else {
+			ASSERT( cur.release == 0 && cur.deadline == 0 );
+		}
+		prev = cur;
+	}
+
+	SYSCALL( task_mode(BACKGROUND_TASK) );
+}
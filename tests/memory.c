@@ -0,0 +1,185 @@
+#include <stdint.h>
+#include <unistd.h>
+#include <string.h>
+
+#include "tests.h"
+#include "litmus.h"
+#include "rt_thread.h"
+#include "arena.h"
+#include "numa.h"
+
+TESTCASE(arena_alloc, ALL,
+	 "arena allocations are aligned, bounded, and tracked")
+{
+	struct rt_arena arena;
+	char *a, *b;
+	long page_size = sysconf(_SC_PAGESIZE);
+
+	SYSCALL( rt_arena_init(&arena, 1000) );
+	ASSERT( arena.size == page_size );
+
+	a = rt_arena_alloc(&arena, 10);
+	b = rt_arena_alloc(&arena, 10);
+	ASSERT( a != NULL && b != NULL );
+	ASSERT( ((uintptr_t) a) % RT_ARENA_ALIGN == 0 );
+	ASSERT( ((uintptr_t) b) % RT_ARENA_ALIGN == 0 );
+	ASSERT( b >= a + 10 );
+	memset(a, 0xff, 10);
+
+	/* exhaustion */
+	ASSERT( rt_arena_alloc(&arena, page_size) == NULL );
+	ASSERT( arena.used == RT_ARENA_ALIGN + 10 );
+
+	rt_arena_reset(&arena);
+	ASSERT( arena.used == 0 );
+	ASSERT( arena.high_water == RT_ARENA_ALIGN + 10 );
+	ASSERT( rt_arena_alloc(&arena, page_size) == a );
+	ASSERT( arena.high_water == page_size );
+
+	rt_arena_destroy(&arena);
+	ASSERT( arena.base == NULL );
+}
+
+TESTCASE(pool_alloc_free, ALL,
+	 "pools hand out and recycle fixed-size objects")
+{
+	struct rt_pool pool;
+	void *objs[4];
+	int i;
+
+	SYSCALL( rt_pool_init(&pool, 3, 4) );
+	ASSERT( pool.obj_size == RT_ARENA_ALIGN );
+
+	for (i = 0; i < 4; i++) {
+		objs[i] = rt_pool_alloc(&pool);
+		ASSERT( objs[i] != NULL );
+	}
+	ASSERT( rt_pool_alloc(&pool) == NULL );
+	ASSERT( pool.in_use == 4 );
+
+	rt_pool_free(&pool, objs[2]);
+	rt_pool_free(&pool, objs[1]);
+	ASSERT( pool.in_use == 2 );
+	ASSERT( rt_pool_alloc(&pool) == objs[1] );
+	ASSERT( pool.high_water == 4 );
+
+	rt_pool_destroy(&pool);
+
+	/* sizes whose product wraps around are rejected */
+	SYSCALL_FAILS( EOVERFLOW, rt_pool_init(&pool, SIZE_MAX / 2, 4) );
+	SYSCALL_FAILS( EOVERFLOW, rt_pool_init(&pool, SIZE_MAX, 1) );
+}
+
+TESTCASE(thread_arena, ALL,
+	 "rt_malloc() allocates from the thread's arena")
+{
+	struct rt_arena arena;
+
+	ASSERT( rt_malloc(1) == NULL );
+
+	SYSCALL( rt_arena_init(&arena, 4096) );
+	set_thread_arena(&arena);
+	ASSERT( get_thread_arena() == &arena );
+	ASSERT( rt_malloc(100) == arena.base );
+	ASSERT( arena.used == 100 );
+
+	rt_arena_destroy(&arena);
+	ASSERT( get_thread_arena() == NULL );
+}
+
+static void* use_stack(void *arg)
+{
+	volatile char buf[16 * 1024];
+	size_t i;
+
+	for (i = 0; i < sizeof(buf); i += 512)
+		buf[i] = 1;
+	return (void*) (uintptr_t) buf[0];
+}
+
+TESTCASE(locked_stack, ALL,
+	 "threads run on locked stacks and report their stack depth")
+{
+	struct rt_stack stack;
+	pthread_t thread;
+	size_t before;
+
+	SYSCALL( rt_stack_alloc(&stack, 64 * 1024) );
+	ASSERT( stack.size == 64 * 1024 );
+	ASSERT( stack.guard > 0 );
+	before = rt_stack_high_water(&stack);
+	ASSERT( before == 0 );
+
+	ASSERT( rt_pthread_create(&thread, &stack, use_stack, NULL) == 0 );
+	ASSERT( pthread_join(thread, NULL) == 0 );
+
+	ASSERT( rt_stack_high_water(&stack) >= 16 * 1024 );
+	ASSERT( rt_stack_high_water(&stack) <= stack.size );
+
+	rt_stack_free(&stack);
+}
+
+TESTCASE(arena_numa_placement, ALL,
+	 "arena pages can be counted and moved to a NUMA node")
+{
+	struct rt_arena arena;
+	struct numa_page_stats stats;
+	long page_size = sysconf(_SC_PAGESIZE);
+	int node;
+
+	/* kernels without CONFIG_NUMA have neither nodes nor move_pages() */
+	if (access("/sys/devices/system/node", F_OK) != 0)
+		return;
+	node = cpus_to_node(NULL, 1);
+	ASSERT( node >= 0 );
+	SYSCALL( rt_arena_init(&arena, 16 * page_size) );
+
+	SYSCALL( count_node_pages(arena.base, arena.size, node, &stats) );
+	ASSERT( stats.pages == 16 );
+	ASSERT( stats.local + stats.remote == 16 );
+	ASSERT( stats.absent == 0 );
+
+	SYSCALL( rt_arena_to_node(&arena, node, NUMA_MEM_MIGRATE) );
+	SYSCALL( count_node_pages(arena.base, arena.size, node, &stats) );
+	ASSERT( stats.local == 16 );
+
+	/* unaligned ranges cover all pages they touch */
+	SYSCALL( count_node_pages(arena.base + page_size - 1, 2, node, &stats) );
+	ASSERT( stats.pages == 2 );
+
+	ASSERT( rt_arena_to_node(&arena, NUMA_MAX_NODES, 0) == -1 );
+	rt_arena_destroy(&arena);
+}
+
+TESTCASE(process_numa_pages, ALL,
+	 "per-node page counts are summed from numa_maps")
+{
+	char fname[] = "/tmp/litmus-numa-XXXXXX";
+	struct numa_page_stats stats;
+	FILE *f;
+	int fd;
+
+	fd = mkstemp(fname);
+	ASSERT( fd >= 0 );
+	f = fdopen(fd, "w");
+	ASSERT( f != NULL );
+	fputs("00400000 default file=/bin/rtspin mapped=3 N0=2 N1=1 "
+	      "kernelpagesize_kB=4\n"
+	      "7f0000000000 bind:1 anon=5 dirty=5 N1=5 kernelpagesize_kB=4\n"
+	      "7f0000100000 default\n", f);
+	fclose(f);
+
+	SYSCALL( count_process_pages(fname, 1, &stats) );
+	ASSERT( stats.pages == 8 );
+	ASSERT( stats.local == 6 );
+	ASSERT( stats.remote == 2 );
+	ASSERT( stats.absent == 0 );
+
+	unlink(fname);
+
+	/* only kernels with CONFIG_NUMA provide numa_maps */
+	if (access("/proc/self/numa_maps", R_OK) != 0)
+		return;
+	SYSCALL( count_process_pages(NULL, 0, &stats) );
+	ASSERT( stats.pages > 0 );
+}
@@ -47,7 +47,7 @@ TESTCASE(pcp_inheritance, P_FP,
 
 	int child_hi, child_lo, child_middle, status, waiters;
 	lt_t delay = ms2ns(100);
-	double start, stop;
+	lt_t start, stop;
 
 	struct rt_task params;
 	init_rt_task_param(&params);
@@ -74,8 +74,8 @@ TESTCASE(pcp_inheritance, P_FP,
 		SYSCALL( wait_for_ts_release() );
 
 		SYSCALL( litmus_lock(od) );
-		start = cputime();
-		while (cputime() - start < 0.25)
+		start = thread_cputime_ns();
+		while (thread_cputime_ns() - start < ms2ns(250))
 			;
 		SYSCALL( litmus_unlock(od) );
 
@@ -93,8 +93,8 @@ TESTCASE(pcp_inheritance, P_FP,
 
 		SYSCALL( wait_for_ts_release() );
 
-		start = cputime();
-		while (cputime() - start < 5)
+		start = thread_cputime_ns();
+		while (thread_cputime_ns() - start < s2ns(5))
 			;
 		SYSCALL( sleep_next_period() );
 		);
@@ -111,17 +111,17 @@ TESTCASE(pcp_inheritance, P_FP,
 
 		SYSCALL( wait_for_ts_release() );
 
-		start = wctime();
+		start = monotonic_ns();
 		/* block on semaphore */
 		SYSCALL( litmus_lock(od) );
 		SYSCALL( litmus_unlock(od) );
-		stop  = wctime();
+		stop  = monotonic_ns();
 
 		/* Assert we had some blocking. */
-		ASSERT( stop - start > 0.1);
+		ASSERT( stop - start > ms2ns(100));
 
 		/* Assert we woke up 'soonish' after the sleep. */
-		ASSERT( stop - start < 1 );
+		ASSERT( stop - start < s2ns(1) );
 
 		SYSCALL( kill(child_middle, SIGUSR2) );
 		SYSCALL( kill(child_lo, SIGUSR2) );
@@ -153,7 +153,7 @@ TESTCASE(srp_ceiling_blocking, P_FP | PSN_EDF,
 
 	int child_hi, child_lo, child_middle, status, waiters;
 	lt_t delay = ms2ns(100);
-	double start, stop;
+	lt_t start, stop;
 
 	struct rt_task params;
 	init_rt_task_param(&params);
@@ -176,8 +176,8 @@ TESTCASE(srp_ceiling_blocking, P_FP | PSN_EDF,
 		SYSCALL( wait_for_ts_release() );
 
 		SYSCALL( litmus_lock(od) );
-		start = cputime();
-		while (cputime() - start < 0.25)
+		start = thread_cputime_ns();
+		while (thread_cputime_ns() - start < ms2ns(250))
 			;
 		SYSCALL( litmus_unlock(od) );
 		);
@@ -194,8 +194,8 @@ TESTCASE(srp_ceiling_blocking, P_FP | PSN_EDF,
 
 		SYSCALL( wait_for_ts_release() );
 
-		start = cputime();
-		while (cputime() - start < 5)
+		start = thread_cputime_ns();
+		while (thread_cputime_ns() - start < s2ns(5))
 			;
 		);
 
@@ -212,14 +212,14 @@ TESTCASE(srp_ceiling_blocking, P_FP | PSN_EDF,
 
 		SYSCALL( wait_for_ts_release() );
 
-		start = wctime();
+		start = monotonic_ns();
 		/* block on semaphore */
 		SYSCALL( litmus_lock(od) );
 		SYSCALL( litmus_unlock(od) );
-		stop  = wctime();
+		stop  = monotonic_ns();
 
 		/* Assert we had "no" blocking (modulo qemu overheads). */
-		ASSERT( stop - start < 0.01);
+		ASSERT( stop - start < ms2ns(10));
 
 		SYSCALL( kill(child_middle, SIGUSR2) );
 		SYSCALL( kill(child_lo, SIGUSR2) );
@@ -281,7 +281,7 @@ TESTCASE(lock_dpcp_pcp, P_FP,
 	int fd, od_dpcp, od_pcp, child_hi, child_lo, status, waiters, cpu;
 	lt_t delay = ms2ns(100);
 	struct rt_task params;
-	double start;
+	lt_t start;
 
 	/* tasks may not unlock resources they don't own */
 	SYSCALL( be_migrate_to_cpu(2) );
@@ -343,8 +343,8 @@ TESTCASE(lock_dpcp_pcp, P_FP,
 
 		/* block on semaphore */
 		SYSCALL( litmus_lock(od_pcp) );
-		start = cputime();
-		while (cputime() - start < 0.25)
+		start = thread_cputime_ns();
+		while (thread_cputime_ns() - start < ms2ns(250))
 			;
 
 		preempted = *mutex;
@@ -1,16 +1,20 @@
 #include <sys/wait.h> /* for waitpid() */
 #include <unistd.h>
+#include <sched.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 
 #include "tests.h"
 #include "litmus.h"
+#include "fork_join.h"
 
 TESTCASE(preempt_on_resume, P_FP | PSN_EDF,
 	 "preempt lower-priority task when a higher-priority task resumes")
 {
 	int child_hi, child_lo, status, waiters;
 	lt_t delay = ms2ns(100);
-	double start, stop;
+	lt_t start, stop;
 
 	struct rt_task params;
 	init_rt_task_param(&params);
@@ -26,9 +30,9 @@ TESTCASE(preempt_on_resume, P_FP | PSN_EDF,
 
 		SYSCALL( wait_for_ts_release() );
 
-		start = cputime();
+		start = thread_cputime_ns();
 
-		while (cputime() - start < 10)
+		while (thread_cputime_ns() - start < s2ns(10))
 			;
 
 		);
@@ -42,23 +46,23 @@ TESTCASE(preempt_on_resume, P_FP | PSN_EDF,
 
 		SYSCALL( wait_for_ts_release() );
 
-		start = cputime();
+		start = thread_cputime_ns();
 
-		while (cputime() - start < 0.1)
+		while (thread_cputime_ns() - start < ms2ns(100))
 			;
 
-		start = wctime();
+		start = monotonic_ns();
 		SYSCALL( lt_sleep(ms2ns(100)) );
-		stop = wctime();
+		stop = monotonic_ns();
 
 		SYSCALL( kill(child_lo, SIGUSR2) );
 
-		if (stop - start >= 0.2)
+		if (stop - start >= ms2ns(200))
 			fprintf(stderr, "\nHi-prio delay = %fsec\n",
-				stop - start - (ms2ns(100) / (float)s2ns(1)));
+				(stop - start - ms2ns(100)) / (float)s2ns(1));
 
 		/* Assert we woke up 'soonish' after the sleep. */
-		ASSERT( stop - start < 0.2 );
+		ASSERT( stop - start < ms2ns(200) );
 		);
 
 
@@ -77,3 +81,164 @@ TESTCASE(preempt_on_resume, P_FP | PSN_EDF,
 }
 
 
+
+static int thread_ran;
+
+static void* report_job_no(void *arg)
+{
+	unsigned int job_no;
+	__sync_fetch_and_add(&thread_ran, 1);
+	/* only real-time tasks have a job number */
+	return (void*) (long) get_job_no(&job_no);
+}
+
+TESTCASE(threads_create_batch, LITMUS,
+	 "litmus_threads_create() admits all threads or none")
+{
+	struct litmus_thread_spec specs[3];
+	pthread_t threads[3];
+	lt_t setup_time;
+	void *ret;
+	int i;
+
+	for (i = 0; i < 3; i++) {
+		init_rt_task_param(&specs[i].params);
+		specs[i].params.exec_cost = ms2ns(10);
+		specs[i].params.period    = ms2ns(100);
+		specs[i].params.cpu       = 0;
+		specs[i].domain = 0;
+		specs[i].stack  = NULL;
+		specs[i].start_routine = report_job_no;
+		specs[i].arg = NULL;
+	}
+
+	thread_ran = 0;
+	SYSCALL( litmus_threads_create(threads, specs, 3, 0, &setup_time) );
+	ASSERT( setup_time > 0 );
+	for (i = 0; i < 3; i++) {
+		pthread_join(threads[i], &ret);
+		ASSERT( ret == NULL );
+	}
+	ASSERT( thread_ran == 3 );
+
+	/* one bad apple: nobody gets to run */
+	specs[1].params.period = 0;
+	thread_ran = 0;
+	SYSCALL_FAILS( EAGAIN,
+		litmus_threads_create(threads, specs, 3, 0, NULL) );
+	ASSERT( thread_ran == 0 );
+}
+
+static int fork_join_calls[64];
+
+static void count_work(int worker, int nworkers, unsigned int job_no,
+		       void *arg)
+{
+	struct fork_join *fj = arg;
+
+	fork_join_calls[worker]++;
+	if (worker == 0 && fork_join_calls[0] == 3)
+		fork_join_stop(fj);
+}
+
+TESTCASE(fork_join_jobs, LITMUS,
+	 "fork-join workers execute each job together")
+{
+	struct fork_join fj;
+	struct rt_task params;
+	lt_t delay = ms2ns(10);
+	int i, waiters;
+
+	init_rt_task_param(&params);
+	params.exec_cost = ms2ns(5);
+	params.period    = ms2ns(50);
+
+	memset(fork_join_calls, 0, sizeof(fork_join_calls));
+	SYSCALL( fork_join_create(&fj, 0, &params, count_work, &fj) );
+	ASSERT( fj.nworkers > 0 && fj.nworkers <= 64 );
+
+	do {
+		waiters = get_nr_ts_release_waiters();
+		ASSERT( waiters >= 0 );
+	} while (waiters != fj.nworkers);
+	SYSCALL( release_ts(&delay) );
+
+	fork_join_join(&fj);
+
+	ASSERT( fj.error == 0 );
+	ASSERT( fj.jobs == 3 );
+	ASSERT( fj.span_max <= fj.span_total );
+	for (i = 0; i < fj.nworkers; i++) {
+		ASSERT( fork_join_calls[i] == 3 );
+		ASSERT( fj.stats[i].jobs == 3 );
+		ASSERT( ((uintptr_t) (fj.stats + i)) % FORK_JOIN_CACHE_LINE == 0 );
+	}
+	fork_join_destroy(&fj);
+}
+
+struct helper {
+	volatile pid_t tid;
+	volatile int done;
+	int rt;
+};
+
+static void* helper_main(void *arg)
+{
+	struct helper *h = arg;
+	struct rt_task params;
+
+	if (h->rt) {
+		init_rt_task_param(&params);
+		params.exec_cost = ms2ns(10);
+		params.period    = ms2ns(100);
+		set_rt_task_param(gettid(), &params);
+	}
+	h->tid = gettid();
+	while (!h->done)
+		lt_sleep(ms2ns(1));
+	return NULL;
+}
+
+static int only_on_cpu0(pid_t tid)
+{
+	cpu_set_t set;
+
+	CPU_ZERO(&set);
+	if (sched_getaffinity(tid, sizeof(set), &set) != 0)
+		return -1;
+	return CPU_COUNT(&set) == 1 && CPU_ISSET(0, &set);
+}
+
+TESTCASE(housekeeping_threads, ALL,
+	 "non-real-time threads are moved to the housekeeping CPUs")
+{
+	struct helper plain = {0, 0, 0}, rt = {0, 0, 1}, late = {0, 0, 0};
+	pthread_t t_plain, t_rt, t_late;
+
+	ASSERT( pthread_create(&t_plain, NULL, helper_main, &plain) == 0 );
+	ASSERT( pthread_create(&t_rt, NULL, helper_main, &rt) == 0 );
+	while (!plain.tid || !rt.tid)
+		lt_sleep(ms2ns(1));
+
+	/* the caller and the plain helper */
+	ASSERT( migrate_housekeeping_threads(0x1) == 2 );
+	ASSERT( only_on_cpu0(gettid()) == 1 );
+	ASSERT( only_on_cpu0(plain.tid) == 1 );
+	if (num_online_cpus() > 1)
+		ASSERT( only_on_cpu0(rt.tid) == 0 );
+
+	/* threads created later are picked up by the watcher */
+	SYSCALL( start_housekeeping_watcher(0x1, ms2ns(5)) );
+	ASSERT( start_housekeeping_watcher(0x1, ms2ns(5)) == -1 );
+	ASSERT( pthread_create(&t_late, NULL, helper_main, &late) == 0 );
+	while (!late.tid)
+		lt_sleep(ms2ns(1));
+	lt_sleep(ms2ns(50));
+	ASSERT( only_on_cpu0(late.tid) == 1 );
+	stop_housekeeping_watcher();
+
+	plain.done = rt.done = late.done = 1;
+	pthread_join(t_plain, NULL);
+	pthread_join(t_rt, NULL);
+	pthread_join(t_late, NULL);
+}
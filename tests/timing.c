@@ -0,0 +1,143 @@
+#include <unistd.h>
+#include <stdio.h>
+
+#include "tests.h"
+#include "litmus.h"
+#include "irq_stats.h"
+
+/* fixed-point conversion is exact only up to rounding of the multiplier */
+#define ASSERT_ABOUT(val, expected, slack)			\
+	ASSERT( (val) + (slack) >= (expected) && (val) <= (expected) + (slack) )
+
+TESTCASE(cycles_to_ns_conversion, ALL,
+	 "cycles_to_ns() converts at the configured frequency")
+{
+	/* 1 GHz: identity */
+	set_cycles_frequency(1000000000ULL);
+	ASSERT( cycles_to_ns(0) == 0 );
+	ASSERT( cycles_to_ns(12345) == 12345 );
+	ASSERT( cycles_to_ns(1ULL << 40) == 1ULL << 40 );
+
+	/* 2.5 GHz: 0.4 ns per cycle */
+	set_cycles_frequency(2500000000ULL);
+	ASSERT_ABOUT( cycles_to_ns(2500000000ULL), 1000000000ULL, 1 );
+	ASSERT_ABOUT( cycles_to_ns(25), 10, 1 );
+
+	/* 19.2 MHz (typical ARM generic timer), exercises smaller shifts */
+	set_cycles_frequency(19200000ULL);
+	ASSERT_ABOUT( cycles_to_ns(19200000ULL), 1000000000ULL, 1 );
+	/* one hour worth of cycles, within a microsecond */
+	ASSERT_ABOUT( cycles_to_ns(19200000ULL * 3600), s2ns(3600ULL), 1000 );
+}
+
+TESTCASE(cycles_calibration, ALL,
+	 "calibrate_cycles() yields a plausible counter frequency")
+{
+	uint64_t hz;
+	cycles_t c0, c1;
+
+	hz = calibrate_cycles(ms2ns(50));
+	ASSERT( hz > 0 );
+
+	c0 = get_cycles_ordered();
+	SYSCALL( lt_sleep(ms2ns(50)) );
+	c1 = get_cycles_ordered();
+
+	/* The sleep should take at least 50ms and not much more. */
+	ASSERT( cycles_to_ns(c1 - c0) >= ms2ns(45) );
+	ASSERT( cycles_to_ns(c1 - c0) <= ms2ns(500) );
+}
+
+TESTCASE(monotonic_clock, ALL,
+	 "monotonic_ns() and thread_cputime_ns() advance")
+{
+	lt_t t0, t1, c0, c1;
+
+	/* the CPU-time interval lies within the wall-clock interval */
+	t0 = monotonic_ns();
+	c0 = thread_cputime_ns();
+	while (thread_cputime_ns() - c0 < ms2ns(10))
+		;
+	c1 = thread_cputime_ns();
+	t1 = monotonic_ns();
+
+	ASSERT( c1 - c0 >= ms2ns(10) );
+	ASSERT( t1 - t0 >= c1 - c0 );
+}
+
+TESTCASE(sleep_until_absolute, ALL,
+	 "lt_sleep_until() wakes up at the requested absolute time")
+{
+	lt_t wake, now;
+
+	wake = monotonic_ns() + ms2ns(20);
+	SYSCALL( lt_sleep_until(wake) );
+	now = monotonic_ns();
+	ASSERT( now >= wake );
+	ASSERT( now < wake + ms2ns(100) );
+
+	/* times in the past return immediately */
+	SYSCALL( lt_sleep_until(now - ms2ns(1)) );
+	ASSERT( monotonic_ns() < now + ms2ns(10) );
+}
+
+TESTCASE(periodic_timer_phase, ALL,
+	 "sleep_next_release() keeps the phase and reports overruns")
+{
+	struct periodic_timer t;
+	lt_t first = monotonic_ns() + ms2ns(10);
+	lt_t now;
+	int i, missed;
+
+	SYSCALL_FAILS( EINVAL, init_periodic_timer(&t, first, 0) );
+	SYSCALL( init_periodic_timer(&t, first, ms2ns(10)) );
+
+	for (i = 0; i < 5; i++) {
+		SYSCALL( sleep_next_release(&t) );
+		now = monotonic_ns();
+		/* wake-ups do not drift away from the release grid */
+		ASSERT( now >= first + i * ms2ns(10) );
+		ASSERT( now <  first + i * ms2ns(10) + ms2ns(5) );
+	}
+	ASSERT( t.overruns == 0 );
+
+	/* overrun by two and a half periods */
+	SYSCALL( lt_sleep(ms2ns(35)) );
+	SYSCALL( missed = sleep_next_release(&t) );
+	ASSERT( missed >= 2 && missed <= 3 );
+	ASSERT( t.overruns == 1 );
+	ASSERT( t.missed == missed );
+
+	/* back on the grid afterwards */
+	SYSCALL( sleep_next_release(&t) );
+	ASSERT( (monotonic_ns() - first) % ms2ns(10) < ms2ns(5) );
+	ASSERT( t.releases == 7 );
+}
+
+TESTCASE(irq_stats_per_job, ALL,
+	 "IRQ accounting attributes the counter's increments to jobs")
+{
+	struct irq_stats irq;
+	struct control_page *cp;
+	uint64_t n;
+
+	SYSCALL( init_irq_stats(&irq, 1000) );
+	cp = get_ctrl_page();
+	ASSERT( cp != NULL );
+
+	irq_job_begin(&irq);
+	n = irq_job_end(&irq);
+	ASSERT( irq.jobs == 1 );
+	ASSERT( irq.irqs == n );
+	ASSERT( irq.jobs_hit == (n != 0) );
+
+	/* simulate interrupts by advancing the counter */
+	irq_job_begin(&irq);
+	cp->irq_count += 3;
+	n = irq_job_end(&irq);
+	ASSERT( n >= 3 );
+	ASSERT( irq.jobs == 2 );
+	ASSERT( irq.max_irqs >= 3 );
+	ASSERT( irq.lost_max >= 3000 );
+	ASSERT( irq.lost_total == irq.irqs * 1000 );
+}